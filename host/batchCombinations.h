@@ -0,0 +1,269 @@
+// Batched host generator that steps many cursors at once with SIMD
+// (c) Maddie Burbage, 2020
+
+#ifndef __BATCH_COMBINATIONS_H
+#define __BATCH_COMBINATIONS_H
+
+#include "combinations.h"
+#include <immintrin.h>
+
+#define BATCH_LANES 16 //Cursors stepped together, whichever kernel runs
+
+/* A sequence split into BATCH_LANES runs of consecutive ranks, one per cursor.
+ * Every run has the same number of full steps, and the first few runs have
+ * one extra string at their end.
+ */
+struct batchState {
+    struct sequence sequence;
+    unsigned long cursors[BATCH_LANES];
+    unsigned long steps; //Steps left where every cursor still has a string
+    unsigned long extra; //Cursors with one more string after those steps
+};
+
+/* Writes the current string of every cursor to out, then steps every cursor,
+ * for the given number of steps. out[step * BATCH_LANES + lane] holds the
+ * string of a lane at a step.
+ */
+typedef void (*batchKernel)(const struct sequence *s, unsigned long *cursors, unsigned long steps, unsigned long *out);
+
+static void batchScalar(const struct sequence *s, unsigned long *cursors, unsigned long steps, unsigned long *out) {
+    unsigned long step;
+    unsigned int next;
+    int lane;
+
+    for(step = 0; step < steps; step++) {
+        for(lane = 0; lane < BATCH_LANES; lane++) {
+            out[step * BATCH_LANES + lane] = cursors[lane];
+            next = cursors[lane]; //The cursor past a run's end is never written
+            sequenceNext(s, cursors[lane], &next);
+            cursors[lane] = next;
+        }
+    }
+}
+
+/* The AVX2 kernel keeps four cursors in each 256-bit vector. The successors
+ * are the same bit arithmetic as nextWeightedCombination and friends, with
+ * branches turned into blends. AVX2 has no unsigned 64-bit comparison, so
+ * both sides are offset by the sign bit first.
+ */
+#define AVX2 __attribute__((target("avx2")))
+
+static inline AVX2 __m256i lessAVX2(__m256i a, __m256i b) {
+    __m256i sign = _mm256_set1_epi64x(LONGTOP);
+    return _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+}
+
+//Counts the bits set in each 64-bit lane, by nibble lookup and byte sums
+static inline AVX2 __m256i countAVX2(__m256i x) {
+    __m256i table = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4, 0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+    __m256i nibbles = _mm256_set1_epi8(0x0f);
+    __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(x, nibbles));
+    __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibbles));
+    return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+}
+
+static inline AVX2 __m256i weightedAVX2(__m256i last, __m256i widthMask) {
+    __m256i one = _mm256_set1_epi64x(1), zero = _mm256_setzero_si256();
+    __m256i next, temp;
+
+    next = _mm256_and_si256(last, _mm256_add_epi64(last, one)); //Discards trailing ones
+    temp = _mm256_xor_si256(next, _mm256_sub_epi64(next, one)); //Marks the start of the last "10"
+    next = _mm256_add_epi64(temp, one);
+    temp = _mm256_and_si256(temp, last);
+    next = _mm256_sub_epi64(_mm256_and_si256(next, last), one);
+    next = _mm256_andnot_si256(_mm256_cmpgt_epi64(zero, next), next);
+    return _mm256_and_si256(_mm256_sub_epi64(_mm256_add_epi64(last, temp), next), widthMask);
+}
+
+//Shared by the cool-er and cool-est successors, which differ only in when the first bit flips
+static inline AVX2 __m256i rotateAVX2(__m256i last, __m256i first, __m256i mask, __m256i shifted, __m256i lastPosition) {
+    __m256i one = _mm256_set1_epi64x(1);
+    __m256i moved = _mm256_cmpeq_epi64(first, one);
+    __m256i rotated = _mm256_or_si256(shifted, _mm256_and_si256(moved, lastPosition));
+    return _mm256_or_si256(rotated, _mm256_andnot_si256(mask, last));
+}
+
+static inline AVX2 __m256i coolerAVX2(__m256i last, int ranged, __m256i cap, __m256i lastLimit, __m256i min, __m256i max) {
+    __m256i one = _mm256_set1_epi64x(1), zero = _mm256_setzero_si256();
+    __m256i cut, trimmed, trailed, mask, lastTemp, lastPosition, far, bit, flipped, first, valid, count;
+
+    cut = _mm256_srli_epi64(last, 1);
+    trimmed = _mm256_or_si256(cut, _mm256_sub_epi64(cut, one)); //Discards trailing zeros
+    trailed = _mm256_xor_si256(trimmed, _mm256_add_epi64(trimmed, one)); //Marks the start of the last "01"
+    mask = _mm256_add_epi64(_mm256_slli_epi64(trailed, 1), one);
+
+    lastTemp = _mm256_add_epi64(trailed, one);
+    far = _mm256_or_si256(_mm256_cmpeq_epi64(lastTemp, zero), lessAVX2(lastLimit, lastTemp));
+    lastPosition = _mm256_blendv_epi8(lastTemp, lastLimit, far);
+
+    bit = _mm256_and_si256(last, one);
+    flipped = _mm256_xor_si256(bit, one);
+    far = lessAVX2(mask, cap); //There is a valid "01", so the first bit keeps its value
+    if(ranged) {
+        count = countAVX2(last);
+        valid = _mm256_blendv_epi8(_mm256_cmpgt_epi64(max, count), _mm256_cmpgt_epi64(count, min), _mm256_cmpeq_epi64(flipped, zero));
+        far = _mm256_or_si256(far, _mm256_xor_si256(valid, _mm256_set1_epi64x(-1)));
+    }
+    first = _mm256_blendv_epi8(flipped, bit, far);
+    return rotateAVX2(last, first, mask, _mm256_and_si256(cut, trailed), lastPosition);
+}
+
+static AVX2 void batchAVX2(const struct sequence *s, unsigned long *cursors, unsigned long steps, unsigned long *out) {
+    __m256i lanes[BATCH_LANES / 4];
+    __m256i widthMask = _mm256_set1_epi64x((1L << s->length) - 1);
+    __m256i cap = _mm256_set1_epi64x(1L << s->length);
+    __m256i lastLimit = _mm256_set1_epi64x(1L << (s->length - 1));
+    __m256i min = _mm256_set1_epi64x(s->min), max = _mm256_set1_epi64x(s->max);
+    unsigned long step;
+    int i;
+
+    for(i = 0; i < BATCH_LANES / 4; i++) {
+        lanes[i] = _mm256_loadu_si256((__m256i *) &cursors[4 * i]);
+    }
+    for(step = 0; step < steps; step++, out += BATCH_LANES) {
+        for(i = 0; i < BATCH_LANES / 4; i++) {
+            _mm256_storeu_si256((__m256i *) &out[4 * i], lanes[i]);
+            if(s->kind == FIXED_WEIGHT) {
+                lanes[i] = weightedAVX2(lanes[i], widthMask);
+            } else {
+                lanes[i] = coolerAVX2(lanes[i], s->kind == RANGED, cap, lastLimit, min, max);
+            }
+        }
+    }
+    for(i = 0; i < BATCH_LANES / 4; i++) {
+        _mm256_storeu_si256((__m256i *) &cursors[4 * i], lanes[i]);
+    }
+}
+
+/* The AVX-512 kernel follows the AVX2 one with eight cursors per vector,
+ * using mask registers for the comparisons and blends.
+ */
+#define AVX512 __attribute__((target("avx512f,avx512bw")))
+
+static inline AVX512 __m512i countAVX512(__m512i x) {
+    __m512i table = _mm512_set4_epi32(0x04030302, 0x03020201, 0x03020201, 0x02010100);
+    __m512i nibbles = _mm512_set1_epi8(0x0f);
+    __m512i low = _mm512_shuffle_epi8(table, _mm512_and_si512(x, nibbles));
+    __m512i high = _mm512_shuffle_epi8(table, _mm512_and_si512(_mm512_srli_epi16(x, 4), nibbles));
+    return _mm512_sad_epu8(_mm512_add_epi8(low, high), _mm512_setzero_si512());
+}
+
+static inline AVX512 __m512i weightedAVX512(__m512i last, __m512i widthMask) {
+    __m512i one = _mm512_set1_epi64(1), zero = _mm512_setzero_si512();
+    __m512i next, temp;
+
+    next = _mm512_and_si512(last, _mm512_add_epi64(last, one)); //Discards trailing ones
+    temp = _mm512_xor_si512(next, _mm512_sub_epi64(next, one)); //Marks the start of the last "10"
+    next = _mm512_add_epi64(temp, one);
+    temp = _mm512_and_si512(temp, last);
+    next = _mm512_sub_epi64(_mm512_and_si512(next, last), one);
+    next = _mm512_mask_blend_epi64(_mm512_cmplt_epi64_mask(next, zero), next, zero);
+    return _mm512_and_si512(_mm512_sub_epi64(_mm512_add_epi64(last, temp), next), widthMask);
+}
+
+static inline AVX512 __m512i coolerAVX512(__m512i last, int ranged, __m512i cap, __m512i lastLimit, __m512i min, __m512i max) {
+    __m512i one = _mm512_set1_epi64(1), zero = _mm512_setzero_si512();
+    __m512i cut, trimmed, trailed, mask, lastTemp, lastPosition, bit, flipped, first, count, rotated;
+    __mmask8 far, valid, moved;
+
+    cut = _mm512_srli_epi64(last, 1);
+    trimmed = _mm512_or_si512(cut, _mm512_sub_epi64(cut, one)); //Discards trailing zeros
+    trailed = _mm512_xor_si512(trimmed, _mm512_add_epi64(trimmed, one)); //Marks the start of the last "01"
+    mask = _mm512_add_epi64(_mm512_slli_epi64(trailed, 1), one);
+
+    lastTemp = _mm512_add_epi64(trailed, one);
+    far = _mm512_cmpeq_epi64_mask(lastTemp, zero) | _mm512_cmplt_epu64_mask(lastLimit, lastTemp);
+    lastPosition = _mm512_mask_blend_epi64(far, lastTemp, lastLimit);
+
+    bit = _mm512_and_si512(last, one);
+    flipped = _mm512_xor_si512(bit, one);
+    far = _mm512_cmplt_epu64_mask(mask, cap); //There is a valid "01", so the first bit keeps its value
+    if(ranged) {
+        count = countAVX512(last);
+        valid = _mm512_cmpeq_epi64_mask(flipped, zero);
+        valid = (valid & _mm512_cmpgt_epi64_mask(count, min)) | (~valid & _mm512_cmplt_epi64_mask(count, max));
+        far |= ~valid;
+    }
+    first = _mm512_mask_blend_epi64(far, flipped, bit);
+    moved = _mm512_cmpeq_epi64_mask(first, one);
+    rotated = _mm512_mask_or_epi64(_mm512_and_si512(cut, trailed), moved, _mm512_and_si512(cut, trailed), lastPosition);
+    return _mm512_or_si512(rotated, _mm512_andnot_si512(mask, last));
+}
+
+static AVX512 void batchAVX512(const struct sequence *s, unsigned long *cursors, unsigned long steps, unsigned long *out) {
+    __m512i lanes[BATCH_LANES / 8];
+    __m512i widthMask = _mm512_set1_epi64((1L << s->length) - 1);
+    __m512i cap = _mm512_set1_epi64(1L << s->length);
+    __m512i lastLimit = _mm512_set1_epi64(1L << (s->length - 1));
+    __m512i min = _mm512_set1_epi64(s->min), max = _mm512_set1_epi64(s->max);
+    unsigned long step;
+    int i;
+
+    for(i = 0; i < BATCH_LANES / 8; i++) {
+        lanes[i] = _mm512_loadu_si512(&cursors[8 * i]);
+    }
+    for(step = 0; step < steps; step++, out += BATCH_LANES) {
+        for(i = 0; i < BATCH_LANES / 8; i++) {
+            _mm512_storeu_si512(&out[8 * i], lanes[i]);
+            if(s->kind == FIXED_WEIGHT) {
+                lanes[i] = weightedAVX512(lanes[i], widthMask);
+            } else {
+                lanes[i] = coolerAVX512(lanes[i], s->kind == RANGED, cap, lastLimit, min, max);
+            }
+        }
+    }
+    for(i = 0; i < BATCH_LANES / 8; i++) {
+        _mm512_storeu_si512(&cursors[8 * i], lanes[i]);
+    }
+}
+
+/* Picks the widest kernel this processor supports */
+static batchKernel chooseBatchKernel(void) {
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return batchAVX512;
+    }
+    if(__builtin_cpu_supports("avx2")) {
+        return batchAVX2;
+    }
+    return batchScalar;
+}
+
+/* Unranks the start of each cursor's run of a sequence */
+static inline void startBatch(struct batchState *state, const struct sequence *s) {
+    unsigned long count = sequenceLength(s);
+    int lane;
+
+    state->sequence = *s;
+    state->steps = count / BATCH_LANES;
+    state->extra = count % BATCH_LANES;
+    for(lane = 0; lane < BATCH_LANES; lane++) {
+        state->cursors[lane] = sequenceString(s, lane * state->steps + ((lane < state->extra)? lane : state->extra));
+    }
+}
+
+/* Writes up to the given number of steps of every cursor into buffer,
+ * interleaved by lane, continuing from where the state last stopped. Once the
+ * full steps run out, the extra strings at the ends of the first runs follow.
+ * The buffer must hold steps * BATCH_LANES strings. Returns the number of
+ * strings written, which is 0 once the sequence is finished.
+ */
+static inline unsigned long fillBatch(unsigned long *buffer, unsigned long steps, struct batchState *state, batchKernel kernel) {
+    unsigned long full, written;
+    int lane;
+
+    full = (steps < state->steps)? steps : state->steps;
+    kernel(&state->sequence, state->cursors, full, buffer);
+    state->steps -= full;
+    written = full * BATCH_LANES;
+
+    if(state->steps == 0 && state->extra > 0 && written + state->extra <= steps * BATCH_LANES) {
+        for(lane = 0; lane < state->extra; lane++) {
+            buffer[written++] = state->cursors[lane];
+        }
+        state->extra = 0;
+    }
+    return written;
+}
+
+#endif //__BATCH_COMBINATIONS_H
@@ -0,0 +1,86 @@
+// Tests for the batched SIMD host generator
+// (c) Maddie Burbage, 2020
+
+#include "batchCombinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define STEPS 1000 //Steps per fill, so runs are split across several fills
+
+/* Fills a whole sequence with one kernel and checks that every lane holds
+ * consecutive ranks of the sequence. Returns the number of mismatches, and
+ * the seconds taken through *seconds.
+ */
+static int testKernel(const struct sequence *s, batchKernel kernel, double *seconds) {
+    struct batchState state;
+    struct timespec start, end;
+    unsigned long *buffer, count, steps, written, total, i, lane, rank;
+    int mismatches = 0;
+
+    count = sequenceLength(s);
+    steps = count / BATCH_LANES;
+    buffer = malloc((count + BATCH_LANES) * sizeof(unsigned long));
+    startBatch(&state, s);
+    total = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while((written = fillBatch(buffer + total, STEPS, &state, kernel)) > 0) {
+        total += written;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    if(total != count) {
+        printf("ERROR: kind %d length %ld wrote %lu of %lu strings\n", s->kind, s->length, total, count);
+        free(buffer);
+        return 1;
+    }
+    for(i = 0; i < count; i++) { //Strings in full steps, then the extra ones
+        lane = (i < steps * BATCH_LANES)? i % BATCH_LANES : i - steps * BATCH_LANES;
+        rank = lane * steps + ((lane < count % BATCH_LANES)? lane : count % BATCH_LANES);
+        rank += (i < steps * BATCH_LANES)? i / BATCH_LANES : steps;
+        if(i % 997 == 0 || count < 100000) { //Sample long sequences
+            if(buffer[i] != sequenceString(s, rank)) {
+                mismatches++;
+            }
+        }
+    }
+    free(buffer);
+    return mismatches;
+}
+
+int main(void) {
+    struct sequence sequences[] = {
+        {FIXED_WEIGHT, 6, 3, 3}, {FIXED_WEIGHT, 24, 12, 12}, {FIXED_WEIGHT, 32, 2, 2},
+        {GENERAL, 3, 0, 3}, {GENERAL, 24, 0, 24}, {GENERAL, 32, 0, 32},
+        {RANGED, 7, 2, 5}, {RANGED, 24, 0, 12}, {RANGED, 32, 30, 32},
+    };
+    batchKernel kernels[3] = {batchScalar, batchAVX2, batchAVX512};
+    const char *names[3] = {"scalar", "AVX2", "AVX-512"};
+    int supported[3];
+    double seconds;
+    unsigned int i;
+    int k, mismatches = 0;
+
+    __builtin_cpu_init();
+    supported[0] = 1;
+    supported[1] = __builtin_cpu_supports("avx2");
+    supported[2] = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+
+    for(i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        if(sequenceLength(&sequences[i]) > 1L << 26) {
+            continue;
+        }
+        for(k = 0; k < 3; k++) {
+            if(supported[k]) {
+                mismatches += testKernel(&sequences[i], kernels[k], &seconds);
+                printf("kind %d, length %ld, %s, %lu strings, %.3f s\n", sequences[i].kind,
+                       sequences[i].length, names[k], sequenceLength(&sequences[i]), seconds);
+            }
+        }
+    }
+    printf("Chosen kernel is %s\n", names[(chooseBatchKernel() == batchAVX512)? 2 : (chooseBatchKernel() == batchAVX2)? 1 : 0]);
+    printf("Batch mismatches: %d\n", mismatches);
+    return mismatches;
+}
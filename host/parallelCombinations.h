@@ -0,0 +1,175 @@
+// Multi-threaded host generator for the combination sequences
+// (c) Maddie Burbage, 2020
+
+#ifndef __PARALLEL_COMBINATIONS_H
+#define __PARALLEL_COMBINATIONS_H
+
+#include "combinations.h"
+#include <pthread.h>
+
+#define MAX_THREADS 64
+#define CHUNK 4096 //Strings a worker claims from its range at a time
+
+//A worker's remaining ranks, [next, end). Other workers may steal the top half
+struct rankRange {
+    pthread_mutex_t lock;
+    unsigned long next;
+    unsigned long end;
+};
+
+struct engine {
+    struct sequence sequence;
+    int threads;
+    struct rankRange ranges[MAX_THREADS];
+    combinationVisitor visit;
+    void **contexts;
+};
+
+struct worker {
+    struct engine *engine;
+    int id;
+};
+
+/* Claims up to CHUNK ranks from the front of a worker's own range. Returns
+ * how many ranks were claimed, starting from *start.
+ */
+static unsigned long claimChunk(struct rankRange *range, unsigned long *start) {
+    unsigned long claimed;
+
+    pthread_mutex_lock(&range->lock);
+    claimed = range->end - range->next;
+    claimed = (claimed < CHUNK)? claimed : CHUNK;
+    *start = range->next;
+    range->next += claimed;
+    pthread_mutex_unlock(&range->lock);
+    return claimed;
+}
+
+/* Counts the ranks left in a worker's range */
+static unsigned long rangeRemaining(struct rankRange *range) {
+    unsigned long remaining;
+
+    pthread_mutex_lock(&range->lock);
+    remaining = range->end - range->next;
+    pthread_mutex_unlock(&range->lock);
+    return remaining;
+}
+
+/* Moves the top half of the busiest other range into an idle worker's
+ * range. Returns 0 when there is no work left anywhere.
+ */
+static int stealRange(struct engine *e, int thief) {
+    struct rankRange *low, *high, *victim, *own = &e->ranges[thief];
+    unsigned long remaining, most, middle;
+    int busiest, i, stolen;
+
+    for(;;) {
+        busiest = -1;
+        most = 0;
+        for(i = 0; i < e->threads; i++) {
+            remaining = (i == thief)? 0 : rangeRemaining(&e->ranges[i]);
+            if(remaining > most) {
+                most = remaining;
+                busiest = i;
+            }
+        }
+        if(busiest < 0) {
+            return 0;
+        }
+
+        //Lock in index order so two workers stealing at once cannot deadlock
+        victim = &e->ranges[busiest];
+        low = (busiest < thief)? victim : own;
+        high = (busiest < thief)? own : victim;
+        pthread_mutex_lock(&low->lock);
+        pthread_mutex_lock(&high->lock);
+        remaining = victim->end - victim->next;
+        stolen = remaining > 0; //The victim may have finished while we looked
+        if(stolen) {
+            middle = victim->end - (remaining + 1) / 2;
+            own->next = middle;
+            own->end = victim->end;
+            victim->end = middle;
+        }
+        pthread_mutex_unlock(&high->lock);
+        pthread_mutex_unlock(&low->lock);
+        if(stolen) {
+            return 1;
+        }
+    }
+}
+
+/* Generates chunks of its range, unranking the first string of each chunk
+ * and stepping through the rest with the successor. Steals when idle.
+ */
+static void *runWorker(void *argument) {
+    struct worker *w = argument;
+    struct engine *e = w->engine;
+    void *context = e->contexts[w->id];
+    unsigned long start, claimed, string, i;
+    unsigned int next = 0;
+
+    do {
+        while((claimed = claimChunk(&e->ranges[w->id], &start)) > 0) {
+            string = sequenceString(&e->sequence, start);
+            e->visit(context, string);
+            for(i = 1; i < claimed; i++) {
+                sequenceNext(&e->sequence, string, &next);
+                string = next;
+                e->visit(context, string);
+            }
+        }
+    } while(stealRange(e, w->id));
+    return NULL;
+}
+
+/* Generates every string of a sequence across several threads, including
+ * the calling thread. Each thread starts with an equal share of the ranks and
+ * calls visit with its own entry of contexts, so the visitor needs no
+ * locking. Strings reach the visitors in no particular order. Returns the
+ * number of strings generated, or 0 for an unsupported thread count.
+ */
+static unsigned long generateParallel(const struct sequence *s, int threads, combinationVisitor visit, void **contexts) {
+    struct engine e;
+    struct worker workers[MAX_THREADS];
+    pthread_t handles[MAX_THREADS];
+    int started[MAX_THREADS];
+    unsigned long count;
+    int i;
+
+    if(threads < 1 || threads > MAX_THREADS) {
+        return 0;
+    }
+    binomial(0, 0); //Fill the shared binomial table before the threads read it
+
+    e.sequence = *s;
+    e.threads = threads;
+    e.visit = visit;
+    e.contexts = contexts;
+    count = sequenceLength(s);
+    for(i = 0; i < threads; i++) {
+        pthread_mutex_init(&e.ranges[i].lock, NULL);
+        e.ranges[i].next = count / threads * i;
+        e.ranges[i].end = (i == threads - 1)? count : count / threads * (i + 1);
+        workers[i].engine = &e;
+        workers[i].id = i;
+    }
+
+    //A range whose thread fails to start is stolen by the others
+    for(i = 1; i < threads; i++) {
+        started[i] = pthread_create(&handles[i], NULL, runWorker, &workers[i]) == 0;
+    }
+    runWorker(&workers[0]);
+    for(i = 1; i < threads; i++) {
+        if(started[i]) {
+            pthread_join(handles[i], NULL);
+        }
+    }
+
+    for(i = 0; i < threads; i++) {
+        pthread_mutex_destroy(&e.ranges[i].lock);
+    }
+    return count;
+}
+
+#endif //__PARALLEL_COMBINATIONS_H
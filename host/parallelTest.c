@@ -0,0 +1,95 @@
+// Tests for the multi-threaded host generator
+// (c) Maddie Burbage, 2020
+
+#include "parallelCombinations.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+//Order-independent summary of the strings a worker saw
+struct tally {
+    unsigned long count;
+    unsigned long sum;
+    unsigned long mixed; //Sum of scrambled strings, to tell apart multisets with equal sums
+};
+
+static unsigned long scramble(unsigned long string) {
+    string ^= string >> 31;
+    string *= 0x7fb5d329728ea185;
+    string ^= string >> 27;
+    return string;
+}
+
+static void tallyString(void *context, unsigned long string) {
+    struct tally *t = context;
+    t->count++;
+    t->sum += string;
+    t->mixed += scramble(string);
+}
+
+/* Tallies a sequence with the serial successor loop from timeTests.c */
+static struct tally tallySerial(const struct sequence *s) {
+    struct tally t = {0, 0, 0};
+    unsigned long string;
+    unsigned int next;
+
+    string = (s->kind == GENERAL)? (1L << s->length) - 1 : (1L << s->min) - 1;
+    tallyString(&t, string);
+    while(sequenceNext(s, string, &next) != -1) {
+        string = next;
+        tallyString(&t, string);
+    }
+    return t;
+}
+
+/* Compares the parallel tally to the serial one for one thread count */
+static int testThreads(const struct sequence *s, struct tally expected, int threads) {
+    struct tally tallies[MAX_THREADS], total = {0, 0, 0};
+    void *contexts[MAX_THREADS];
+    int i;
+
+    memset(tallies, 0, sizeof(tallies));
+    for(i = 0; i < threads; i++) {
+        contexts[i] = &tallies[i];
+    }
+    generateParallel(s, threads, tallyString, contexts);
+    for(i = 0; i < threads; i++) {
+        total.count += tallies[i].count;
+        total.sum += tallies[i].sum;
+        total.mixed += tallies[i].mixed;
+    }
+
+    if(total.count != expected.count || total.sum != expected.sum || total.mixed != expected.mixed) {
+        printf("ERROR: kind %d length %ld min %ld max %ld threads %d: %lu strings, expected %lu\n",
+               s->kind, s->length, s->min, s->max, threads, total.count, expected.count);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    struct sequence sequences[] = {
+        {FIXED_WEIGHT, 4, 2, 2}, {FIXED_WEIGHT, 20, 10, 10}, {FIXED_WEIGHT, 24, 3, 3},
+        {GENERAL, 1, 0, 1}, {GENERAL, 12, 0, 12}, {GENERAL, 22, 0, 22},
+        {RANGED, 8, 0, 4}, {RANGED, 16, 3, 9}, {RANGED, 22, 0, 11}, {RANGED, 5, 5, 5},
+    };
+    int threadCounts[] = {1, 2, 3, 4, 8, 17};
+    struct tally expected;
+    struct timespec start, end;
+    unsigned int i, j;
+    int mismatches = 0;
+
+    for(i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        expected = tallySerial(&sequences[i]);
+        for(j = 0; j < sizeof(threadCounts) / sizeof(threadCounts[0]); j++) {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            mismatches += testThreads(&sequences[i], expected, threadCounts[j]);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            printf("kind %d, length %ld, threads %d, %lu strings, %.3f s\n", sequences[i].kind,
+                   sequences[i].length, threadCounts[j], expected.count,
+                   (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+        }
+    }
+    printf("Parallel mismatches: %d\n", mismatches);
+    return mismatches;
+}
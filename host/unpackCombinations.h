@@ -0,0 +1,101 @@
+// Vectorized host unpacker for bit-packed combination streams
+// (c) Maddie Burbage, 2020
+
+#ifndef __UNPACK_COMBINATIONS_H
+#define __UNPACK_COMBINATIONS_H
+
+#include "packedCombinations.h"
+#include <immintrin.h>
+
+#define UNPACK_WIDTH 32 //The longest strings the vector kernels unpack
+
+/* Unpacks count strings of length n from a packed stream into out, starting
+ * from the string at index first, in the same way as unpackStream.
+ */
+typedef void (*unpackKernel)(const unsigned long *buffer, long n, unsigned long first, unsigned long count, unsigned long *out);
+
+static void unpackScalar(const unsigned long *buffer, long n, unsigned long first, unsigned long count, unsigned long *out) {
+    unpackStream(out, buffer, n, first, count);
+}
+
+/* The vector kernels load the words holding a group of strings once, then
+ * move each string's two words into its lane with a permute and shift them
+ * together. Strings up to 32 bits long, starting anywhere in a word, keep a
+ * group of four within four words and a group of eight within eight. A group
+ * is only unpacked this way when all of its words lie within the strings
+ * asked for, and the strings past the last full group are left to the scalar
+ * code, so nothing is read past the end of the stream.
+ */
+#define AVX2 __attribute__((target("avx2")))
+#define AVX512 __attribute__((target("avx512f")))
+
+//The last word holding any of the strings asked for
+static inline unsigned long lastUnpackWord(long n, unsigned long first, unsigned long count) {
+    return ((first + count) * n - 1) / 64;
+}
+
+static AVX2 void unpackAVX2(const unsigned long *buffer, long n, unsigned long first, unsigned long count, unsigned long *out) {
+    __m256i steps, bits, base, rel, shift, low, high, index, data;
+    __m256i mask = _mm256_set1_epi64x((1L << n) - 1), one = _mm256_set1_epi64x(1), wordBits = _mm256_set1_epi64x(64);
+    unsigned long i, start, lastWord = lastUnpackWord(n, first, count);
+
+    if(n > UNPACK_WIDTH || count == 0) {
+        unpackScalar(buffer, n, first, count, out);
+        return;
+    }
+    steps = _mm256_setr_epi64x(0, n, 2 * n, 3 * n);
+    for(i = 0; i + 4 <= count && (first + i) * n / 64 + 3 <= lastWord; i += 4) {
+        start = (first + i) * n;
+        bits = _mm256_add_epi64(_mm256_set1_epi64x(start % 64), steps); //Bit of each string from the group's first word
+        data = _mm256_loadu_si256((const __m256i *) (buffer + start / 64));
+        rel = _mm256_srli_epi64(bits, 6);
+        shift = _mm256_and_si256(bits, _mm256_set1_epi64x(63));
+
+        base = _mm256_slli_epi64(rel, 1); //Each 64-bit word is a pair of 32-bit elements for the permute
+        index = _mm256_or_si256(base, _mm256_slli_epi64(_mm256_add_epi64(base, one), 32));
+        low = _mm256_srlv_epi64(_mm256_permutevar8x32_epi32(data, index), shift);
+        base = _mm256_add_epi64(base, _mm256_set1_epi64x(2));
+        index = _mm256_or_si256(base, _mm256_slli_epi64(_mm256_add_epi64(base, one), 32));
+        high = _mm256_sllv_epi64(_mm256_permutevar8x32_epi32(data, index), _mm256_sub_epi64(wordBits, shift)); //Shifts of 64 give 0
+        _mm256_storeu_si256((__m256i *) (out + i), _mm256_and_si256(_mm256_or_si256(low, high), mask));
+    }
+    unpackScalar(buffer, n, first + i, count - i, out + i);
+}
+
+static AVX512 void unpackAVX512(const unsigned long *buffer, long n, unsigned long first, unsigned long count, unsigned long *out) {
+    __m512i steps, bits, rel, shift, low, high, data;
+    __m512i mask = _mm512_set1_epi64((1L << n) - 1), one = _mm512_set1_epi64(1), wordBits = _mm512_set1_epi64(64);
+    unsigned long i, start, lastWord = lastUnpackWord(n, first, count);
+
+    if(n > UNPACK_WIDTH || count == 0) {
+        unpackScalar(buffer, n, first, count, out);
+        return;
+    }
+    steps = _mm512_setr_epi64(0, n, 2 * n, 3 * n, 4 * n, 5 * n, 6 * n, 7 * n);
+    for(i = 0; i + 8 <= count && (first + i) * n / 64 + 7 <= lastWord; i += 8) {
+        start = (first + i) * n;
+        bits = _mm512_add_epi64(_mm512_set1_epi64(start % 64), steps);
+        data = _mm512_loadu_si512((const void *) (buffer + start / 64));
+        rel = _mm512_srli_epi64(bits, 6);
+        shift = _mm512_and_si512(bits, _mm512_set1_epi64(63));
+
+        low = _mm512_srlv_epi64(_mm512_permutexvar_epi64(rel, data), shift);
+        high = _mm512_sllv_epi64(_mm512_permutexvar_epi64(_mm512_add_epi64(rel, one), data), _mm512_sub_epi64(wordBits, shift));
+        _mm512_storeu_si512((void *) (out + i), _mm512_and_si512(_mm512_or_si512(low, high), mask));
+    }
+    unpackScalar(buffer, n, first + i, count - i, out + i);
+}
+
+//Picks the widest kernel the processor supports
+static unpackKernel chooseUnpackKernel(void) {
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) {
+        return unpackAVX512;
+    }
+    if(__builtin_cpu_supports("avx2")) {
+        return unpackAVX2;
+    }
+    return unpackScalar;
+}
+
+#endif //__UNPACK_COMBINATIONS_H
@@ -0,0 +1,87 @@
+// Tests for the vectorized packed-stream unpacker
+// (c) Maddie Burbage, 2020
+
+#include "unpackCombinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define WINDOWS 200 //Windows of each stream unpacked and compared
+
+/* Packs a sequence, then unpacks windows of it with one kernel, starting and
+ * ending at awkward places, and compares them with the scalar unpacker. The
+ * whole stream is then unpacked and timed. Returns the number of mismatches,
+ * and the seconds taken through *seconds.
+ */
+static int testKernel(const struct sequence *s, unpackKernel kernel, double *seconds) {
+    struct timespec start, end;
+    unsigned long *buffer, *out, *expected, count, first, length, i;
+    int w, mismatches = 0;
+
+    count = sequenceLength(s);
+    buffer = malloc(packedStreamBytes(count, s->length));
+    out = malloc(count * sizeof(unsigned long));
+    expected = malloc(count * sizeof(unsigned long));
+    writePackedStream(buffer, s);
+    srand(s->length);
+
+    for(w = 0; w < WINDOWS; w++) {
+        first = (w == 0)? 0 : rand() % count;
+        length = (w == 0)? count : rand() % (count - first + 1);
+        length = (w % 2 == 1 && length > 40)? length % 40 : length; //Many short windows as well
+        kernel(buffer, s->length, first, length, out);
+        unpackStream(expected, buffer, s->length, first, length);
+        if(memcmp(out, expected, length * sizeof(unsigned long)) != 0) {
+            printf("ERROR: kind %d length %ld window of %lu from %lu\n", s->kind, s->length, length, first);
+            mismatches++;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    kernel(buffer, s->length, 0, count, out);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    for(i = 0; i < count; i += 997) {
+        if(out[i] != sequenceString(s, i)) {
+            mismatches++;
+        }
+    }
+
+    free(buffer);
+    free(out);
+    free(expected);
+    return mismatches;
+}
+
+int main(void) {
+    struct sequence sequences[] = {
+        {FIXED_WEIGHT, 6, 3, 3}, {FIXED_WEIGHT, 24, 12, 12}, {FIXED_WEIGHT, 32, 2, 2},
+        {GENERAL, 1, 0, 1}, {GENERAL, 13, 0, 13}, {GENERAL, 20, 0, 20},
+        {RANGED, 7, 2, 5}, {RANGED, 23, 0, 8}, {RANGED, 32, 30, 32},
+    };
+    unpackKernel kernels[3] = {unpackScalar, unpackAVX2, unpackAVX512};
+    const char *names[3] = {"scalar", "AVX2", "AVX-512"};
+    int supported[3];
+    double seconds;
+    unsigned int i;
+    int k, mismatches = 0;
+
+    __builtin_cpu_init();
+    supported[0] = 1;
+    supported[1] = __builtin_cpu_supports("avx2");
+    supported[2] = __builtin_cpu_supports("avx512f");
+
+    for(i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        for(k = 0; k < 3; k++) {
+            if(supported[k]) {
+                mismatches += testKernel(&sequences[i], kernels[k], &seconds);
+                printf("kind %d, length %ld, %s, %lu strings, %.4f s\n", sequences[i].kind,
+                       sequences[i].length, names[k], sequenceLength(&sequences[i]), seconds);
+            }
+        }
+    }
+    printf("Chosen kernel is %s\n", names[(chooseUnpackKernel() == unpackAVX512)? 2 : (chooseUnpackKernel() == unpackAVX2)? 1 : 0]);
+    printf("Unpack mismatches: %d\n", mismatches);
+    return mismatches;
+}
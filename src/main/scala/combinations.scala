@@ -8,17 +8,26 @@ import freechips.rocketchip.config._ //For Config
 import freechips.rocketchip.diplomacy._ //For LazyModule
 import freechips.rocketchip.rocket.{TLBConfig, HellaCacheReq} //For outward connections
 
-//Wrapper for the accelerator
-class Combinations(opcodes: OpcodeSet)(implicit p: Parameters) extends LazyRoCC(opcodes) {
+//Wrapper for the accelerator, with a number of lanes that each find one string per cycle in memory mode,
+//a number of stores that may be waiting on the cache at once, a number of cursor contexts, and the element size
+//in bytes that the lanes group into one store
+class Combinations(opcodes: OpcodeSet, val lanes: Int = 1, val inFlight: Int = 2, val contexts: Int = 4, val storeBytes: Int = 8)(implicit p: Parameters) extends LazyRoCC(opcodes) {
+    require(isPow2(storeBytes) && storeBytes <= 8, "Elements must be 1, 2, 4 or 8 bytes")
+    require(isPow2(lanes) && lanes * storeBytes <= 8, "Lanes must be a power of two, up to the strings of storeBytes each that fit in one store")
+    require(inFlight >= 2 && inFlight <= 64, "Stores in flight must each have their own tag, of up to 6 bits")
+    require(isPow2(contexts) && contexts >= 2, "Cursor contexts are chosen by the low bits of rs2")
     override lazy val module = new CombinationsImp(this)
 }
 
 //Main accelerator class, directs instruction inputs to functions for computation
 class CombinationsImp(outer: Combinations)(implicit p: Parameters) extends LazyRoCCModuleImp(outer){
-    //Accelerator states: idle, busy (accessing memory), resp (sending response)
-    val s_idle :: s_busy :: s_resp :: Nil = Enum(Bits(), 3)
+    //Accelerator states: idle, busy (accessing memory), resp (sending response), flag (storing the done word),
+    //check (loading a ring's tail until there is room to store), rank (waiting on the rank unit)
+    val s_idle :: s_busy :: s_resp :: s_flag :: s_check :: s_rank :: Nil = Enum(Bits(), 6)
     val state = Reg(init = s_idle) //State idle until handling an instruction
     val tryStore = state === s_busy
+    val flagging = state === s_flag
+    val checking = state === s_check
 
     //Instruction inputs
     val length = Reg(init = io.cmd.bits.rs1) //Length of binary string
@@ -29,6 +38,29 @@ class CombinationsImp(outer: Combinations)(implicit p: Parameters) extends LazyR
     //Always-updated versions of the inputs
     val fastLength = Mux(io.cmd.fire(), io.cmd.bits.rs1, length)
     val fastPrevious = Mux(io.cmd.fire(), io.cmd.bits.rs2, previous)
+    //Store format for memory functions, from bits 19-18 of rs1: 0 stores full strings, 1 stores delta-encoded blocks,
+    //and 2 packs strings back to back at exactly their length
+    //Ring functions (bit 5 set) always store full 8-byte strings
+    //The same bits hold the kind of sequence for rank and unrank (3 and 7), which never store, so format is only
+    //meaningful while a memory function runs
+    val ring = function(5)
+    //Ring functions hold the log of their number of slots in bits 26-22 of rs1, clamped to 1-16 so each half of the
+    //ring holds at least one slot and its count fits in remaining
+    val ringLog = Mux(fastLength(26,22) === 0.U, 1.U, Mux(fastLength(26,22) > 16.U, 16.U, fastLength(26,22)))
+    val format = Mux(ring, 0.U, length(19,18))
+    val deltaStores = format === 1.U
+    val packedStores = format === 2.U
+    //Bytes per full-string store, as a power of two: bits 21-20 of rs1 halve the default of 8 bytes once for each step
+    val storeSize = Mux(format === 0.U && !ring, 3.U(2.W) - length(21,20), 3.U(2.W))
+    //Bounded memory functions (12-14) store at most the count in bits 31-22 of rs1, plus one, starting from the string
+    //in bits 63-32, and respond with the string after the last one stored
+    val bounded = function(3)
+    val fastBounded = Mux(io.cmd.fire(), io.cmd.bits.inst.funct(3), bounded)
+    //Asynchronous memory functions (bit 4 set) respond at once, then set the done word at the address in rs2 once
+    //the strings stored after it are complete
+    val asynchronous = function(4) || ring
+    val asyncResp = Reg(init = Bool(false)) //An asynchronous function's response is waiting
+    val doneAddress = Reg(UInt(64.W)) //The address of the done word
 
 
     //Answers for each function: FixedWeight, General, Ranged, then memory versions of each (functions 0-6)
@@ -36,15 +68,11 @@ class CombinationsImp(outer: Combinations)(implicit p: Parameters) extends LazyR
 
 
     //Command and response states
-    io.cmd.ready := state === s_idle
-    io.resp.valid := state === s_resp
+    io.cmd.ready := state === s_idle && !asyncResp
+    io.resp.valid := state === s_resp || asyncResp
 
     //Accelerator response data
     val summedReturns = Reg(init = 0.U(64.W))
-    //For a 3-bit function code, bit 2 sets whether memory is used or not, and bits 1 and 0 set which combination to use
-    val lookups = Array(0.U->outputs(0),1.U->outputs(1), 2.U->outputs(2),
-        4.U->summedReturns, 5.U->summedReturns, 6.U->summedReturns)
-    io.resp.bits.data := MuxLookup(function, outputs(0), lookups)
     io.resp.bits.rd := rd
 
 
@@ -56,11 +84,14 @@ class CombinationsImp(outer: Combinations)(implicit p: Parameters) extends LazyR
     	rd := io.cmd.bits.inst.rd
     	function := io.cmd.bits.inst.funct
 
-        //Whether it's a memory-using instruction or not (bit 2 set in the function code)
-    	when(io.cmd.bits.inst.funct(2)===1.U) {
+        //Whether it's a memory-using instruction or not (bit 2 set in the function code, as for the bounded functions,
+        //but not unrank)
+    	when(io.cmd.bits.inst.funct(2)===1.U && io.cmd.bits.inst.funct =/= 7.U) {
     	  state := s_busy
     	  summedReturns := 0.U
-    	  currentAddress := io.cmd.bits.rs2
+    	  currentAddress := Mux(io.cmd.bits.inst.funct(5), io.cmd.bits.rs2 + 16.U, Mux(io.cmd.bits.inst.funct(4), io.cmd.bits.rs2 + 8.U, io.cmd.bits.rs2))
+    	  doneAddress := io.cmd.bits.rs2
+    	  asyncResp := io.cmd.bits.inst.funct(4) || io.cmd.bits.inst.funct(5)
     	} .otherwise {
             previous := io.cmd.bits.rs2
     	    state := s_resp
@@ -69,54 +100,262 @@ class CombinationsImp(outer: Combinations)(implicit p: Parameters) extends LazyR
 
     //When done with an instruction
     when(io.resp.fire()) {
-        state := s_idle
+        asyncResp := Bool(false)
+        when(state === s_resp) {
+            state := s_idle
+        }
+    }
+
+    //Jump-ahead instructions (8-10) find the string k places after the one in bits 63-32 of rs1, with k in rs2,
+    //or -1 past the end of the sequence, by ranking the string and unranking its rank plus k.
+    //Rank (3) finds the position of the string in rs2, and unrank (7) the string at the position in rs2, or -1 past
+    //the end, for the sequence of the kind in bits 19-18 of rs1.
+    val rankUnit = Module(new RankUnit)
+    val rankResult = Reg(UInt(64.W))
+    val jump = io.cmd.bits.inst.funct(3) && !io.cmd.bits.inst.funct(2) && io.cmd.bits.inst.funct(1,0) =/= 3.U
+    val rankFunction = io.cmd.bits.inst.funct === 3.U || io.cmd.bits.inst.funct === 7.U
+    rankUnit.io.req.valid := io.cmd.fire() && (jump || rankFunction)
+    rankUnit.io.req.bits.op := Mux(jump, rankOps.jump, Mux(io.cmd.bits.inst.funct(2), rankOps.unrank, rankOps.rank))
+    //Rank and unrank read their kind from the bits that hold the store format for memory functions
+    rankUnit.io.req.bits.kind := Mux(jump, io.cmd.bits.inst.funct(1,0), io.cmd.bits.rs1(19,18))
+    rankUnit.io.req.bits.length := io.cmd.bits.rs1(5,0)
+    rankUnit.io.req.bits.min := io.cmd.bits.rs1(11,6)
+    rankUnit.io.req.bits.max := io.cmd.bits.rs1(17,12)
+    rankUnit.io.req.bits.string := Mux(jump, io.cmd.bits.rs1(63,32), io.cmd.bits.rs2)
+    rankUnit.io.req.bits.input := io.cmd.bits.rs2
+    when(io.cmd.fire() && (jump || rankFunction)) {
+        state := s_rank
+    }
+    when(rankUnit.io.resp.valid) {
+        rankResult := rankUnit.io.resp.bits
+        state := s_resp
+    }
+
+    //Range instructions (11) set the string in rs1 for the next function 4-6 to start from and the string in rs2 for
+    //it to stop before, or -1 to run to the end of the sequence, so several accelerators can each store a slice
+    val rangeStart = Reg(UInt(32.W))
+    val rangeEnd = Reg(UInt(32.W))
+    val rangeSet = Reg(init = Bool(false)) //A range waits for the next memory function
+    val ranged = Reg(init = Bool(false)) //The memory function running stores a range
+    when(io.cmd.fire()) {
+        when(io.cmd.bits.inst.funct === 11.U) {
+            rangeStart := io.cmd.bits.rs1(31,0)
+            rangeEnd := io.cmd.bits.rs2(31,0)
+            rangeSet := Bool(true)
+        } .elsewhen(io.cmd.bits.inst.funct(2) && io.cmd.bits.inst.funct =/= 7.U) {
+            ranged := rangeSet && !io.cmd.bits.inst.funct(3)
+            rangeSet := Bool(false)
+        }
+    }
+    val fastRanged = Mux(io.cmd.fire(), rangeSet && io.cmd.bits.inst.funct(2) && !io.cmd.bits.inst.funct(3), ranged)
+    val stopString = Mux(fastRanged, rangeEnd, nextCombination.doneSignal)
+
+    //Cursor instructions (bit 6 set) keep a sequence in one of several contexts, chosen by the low bits of rs2.
+    //Opening a cursor (64-66) saves the constraints from rs1 with the kind of sequence and the start string from bits
+    //63-32 of rs1, and responds with the start string. Each next instruction (67) sets up the registers as function
+    //0-2 would find them, then saves the string it responds with.
+    val contexts = outer.contexts
+    val cursorConstraints = Reg(Vec(contexts, UInt(18.W)))
+    val cursorKinds = Reg(Vec(contexts, UInt(2.W)))
+    val cursorStrings = Reg(Vec(contexts, UInt(64.W)))
+    val cursorId = Reg(UInt(log2Ceil(contexts).W))
+    val cursorNext = Reg(init = Bool(false)) //The response is the cursor's next string
+    when(io.cmd.fire()) {
+        val id = io.cmd.bits.rs2(log2Ceil(contexts) - 1, 0)
+        cursorNext := io.cmd.bits.inst.funct(6) && io.cmd.bits.inst.funct(1,0) === 3.U
+        cursorId := id
+        when(io.cmd.bits.inst.funct(6)) {
+            when(io.cmd.bits.inst.funct(1,0) === 3.U) {
+                length := cursorConstraints(id)
+                previous := cursorStrings(id)
+                function := cursorKinds(id)
+            } .otherwise {
+                cursorConstraints(id) := io.cmd.bits.rs1(17,0)
+                cursorKinds(id) := io.cmd.bits.inst.funct(1,0)
+                cursorStrings(id) := io.cmd.bits.rs1(63,32)
+                previous := io.cmd.bits.rs1(63,32)
+            }
+        }
+    }
+    when(io.resp.fire() && cursorNext) {
+        cursorStrings(cursorId) := io.resp.bits.data
     }
 
 
-    //Memory-access state
-    val memAccesses = Reg(init = 0.U(4.W)) //Whether all memory requests have been resolved
-    val accessesChange = Wire(UInt(4.W))
-    accessesChange := (io.mem.req.fire() & 1.U(4.W)) - (io.mem.resp.valid & 1.U(4.W))//The latest amount of memory accesses either started or finished
+    //Memory-access state: every store in flight holds its own tag from a pool until the cache acknowledges it
+    val inFlight = outer.inFlight
+    val freeTags = Reg(init = Fill(inFlight, UInt(1, 1))) //One bit per tag, set while the tag is free
+    val nextTag = PriorityEncoder(freeTags) //The lowest free tag, given to the next store
+    val tagReady = freeTags.orR //A store can be sent
+    val allAcknowledged = freeTags.andR //No stores are in flight
+    val newStoreSent = Wire(Bool()) //A store is sent for the first time, taking the next tag
+    val takenTag = Mux(newStoreSent, UIntToOH(nextTag, inFlight), 0.U(inFlight.W))
+    val returnedTag = Mux(io.mem.resp.valid, UIntToOH(io.mem.resp.bits.tag(log2Ceil(inFlight) - 1, 0), inFlight), 0.U(inFlight.W))
+    freeTags := (freeTags & ~takenTag) | returnedTag
 
     //Source of new combination data
-    val nextCombinations = Array(memoryAccess.cycleCombinations(fastLength, io.mem.req.fire(), io.cmd.fire(), 0), memoryAccess.cycleCombinations(fastLength, io.mem.req.fire(), io.cmd.fire(), 1), memoryAccess.cycleCombinations(fastLength, io.mem.req.fire(), io.cmd.fire(), 2))
-    val memLookups = Array(0.U -> nextCombinations(0), 1.U -> nextCombinations(1), 2.U -> nextCombinations(2))
+    val lanes = outer.lanes
+    val advance = Wire(Bool()) //Whether the current strings have been stored or encoded
+    val steps = Wire(UInt(4.W)) //How many strings were stored or encoded
+    val nextCombinations = (0 to 2).map(kind => memoryAccess.cycleCombinations(fastLength, advance, io.cmd.fire(), kind, lanes, steps, fastBounded, fastRanged, rangeStart, stopString))
+    val laneStreams = (0 until lanes).map(lane => MuxLookup(function(1,0), nextCombinations(0)(lane), Array(0.U -> nextCombinations(0)(lane), 1.U -> nextCombinations(1)(lane), 2.U -> nextCombinations(2)(lane))))
     val combinationStream =  Wire(UInt(64.W))
-    combinationStream := MuxLookup(function(1,0), nextCombinations(0), memLookups)
+    combinationStream := laneStreams(0)
+
+    //For a 4-bit function code, bit 3 sets whether the stores are bounded, bit 2 sets whether memory is used or not,
+    //and bits 1 and 0 set which combination to use
+    val lookups = Array(0.U->outputs(0),1.U->outputs(1), 2.U->outputs(2),
+        4.U->summedReturns, 5.U->summedReturns, 6.U->summedReturns,
+        12.U->combinationStream, 13.U->combinationStream, 14.U->combinationStream,
+        3.U->rankResult, 7.U->rankResult, 8.U->rankResult, 9.U->rankResult, 10.U->rankResult, 11.U->0.U,
+        64.U->previous, 65.U->previous, 66.U->previous)
+    val cursorOver = cursorNext && previous === nextCombination.doneSignal //A cursor past its last string stays there
+    io.resp.bits.data := Mux(asynchronous, 0.U, Mux(cursorOver, nextCombination.doneSignal, MuxLookup(function, outputs(0), lookups)))
+
+    //Multi-lane stores: full strings smaller than 8 bytes are grouped, one per lane, into a single store of up to 8 bytes.
+    //The last strings of a cycle, which may not fill a group, are stored one at a time. The cache port is 8 bytes wide,
+    //so lanes are capped at the strings of the configured element size that fill one store. Larger elements, and the
+    //delta and packed formats, store one string per cycle whatever the lanes.
+    val groupCounts = (0 to 3).map(size => math.min(lanes, 8 >> size)) //Strings per group for each element size
+    val groupCount = MuxLookup(storeSize, 1.U, (0 to 3).map(size => size.U -> groupCounts(size).U))
+    val groupEnd = MuxLookup(storeSize, laneStreams(0), (0 to 3).map(size => size.U -> laneStreams(groupCounts(size) - 1)))
+    val remaining = Reg(UInt(17.W)) //Strings left to store in a bounded chunk or half of a ring
+    val written = Reg(UInt(64.W)) //Strings stored in the ring
+    val chunked = bounded || ring
+    val grouped = format === 0.U && groupEnd =/= nextCombination.doneSignal && (!chunked || remaining >= groupCount) //Every string in the group is in the cycle
+    val groupSize = MuxLookup(storeSize, storeSize, (0 to 3).map(size => size.U -> (size + log2Ceil(groupCounts(size))).U))
+    val groupData = MuxLookup(storeSize, combinationStream, (0 to 3).map(size =>
+        size.U -> Cat((0 until groupCounts(size)).reverse.map(lane => laneStreams(lane)((8 << size) - 1, 0)))))
+    val requestSize = Mux(grouped, groupSize, storeSize)
+    steps := Mux(grouped, groupCount, 1.U)
+
+    //Delta-encoded stores: each 64-byte block holds a keyframe string, then a one-byte code for each of the next 56 steps
+    val blockStep = Reg(init = 0.U(6.W)) //The current string's place in its block
+    val codeBuffer = Reg(init = 0.U(64.W)) //Codes waiting to be stored, lowest byte first
+    val lastSent = Reg(UInt(64.W)) //The string before the current one
+    val code = Mux(function(1,0) === 0.U, deltaCode.fixedWeight(lastSent, combinationStream), deltaCode.rotateDown(length, lastSent, combinationStream))
+    val packedCodes = (codeBuffer | (code << Cat((blockStep - 1.U)(2,0), 0.U(3.W))))(63,0)
+    val codeWordFull = blockStep(2,0) === 0.U //Keyframes and every eighth code fill a word
+    val flushCodes = deltaStores && blockStep =/= 0.U && blockStep(2,0) =/= 1.U //Codes are left in the buffer
+
+    //Bit-packed stores: each string takes exactly its length in bits, filling 64-bit words from the lowest bit up
+    val packBuffer = Reg(init = 0.U(64.W)) //Bits waiting to be stored
+    val packFill = Reg(init = 0.U(6.W)) //The number of bits waiting
+    val packedBits = packBuffer | (combinationStream(31,0) << packFill)
+    val packWordFull = packFill +& length(5,0) >= 64.U //The current string fills the word, and any bits left over start the next
+    val flushBits = packedStores && packFill =/= 0.U //Bits are left in the buffer
+
+    val needsStore = Mux(deltaStores, codeWordFull, !packedStores || packWordFull)
+    val flushStores = flushCodes || flushBits
+
+    //Store queue: new stores wait in a short queue, so the strings keep advancing while the cache is busy.
+    //The RoCC port reaches the cache through rocket-chip's SimpleHellaCacheIF, which replays any store the cache
+    //nacks itself, so every store sent is acknowledged without being sent again from here.
+    val newStores = Module(new Queue(new MemoryRequest, 2))
     //Request and response controls
     //When a request is sent, set up next cycle's response data
-    when(io.mem.req.fire()) {
-        memAccesses := memAccesses + accessesChange
-        currentAddress := currentAddress + 8.U
-	printf("combo: %x addr: %x mem %x\n", combinationStream, currentAddress, memAccesses)
+    when(tryStore && newStores.io.enq.fire()) {
+        currentAddress := currentAddress + (1.U << requestSize)
     }
 
     //When a response is received, save response data
     when(io.mem.resp.valid) {
-        memAccesses := memAccesses + accessesChange
         summedReturns := summedReturns + io.mem.resp.bits.data
-        printf("tag: %x addr: %x mem %x\n", io.mem.resp.bits.tag, io.mem.resp.bits.addr, memAccesses)
     }
 
 
     //Controls for accessing memory
-    val cycleOver = combinationStream === nextCombination.doneSignal
-    val finished = cycleOver //&& memAccesses === 0.U
+    val sequenceOver = combinationStream === nextCombination.doneSignal
+    val cycleOver = sequenceOver || (chunked && remaining === 0.U) //The sequence, the chunk or the half ring has ended
+    val finished = cycleOver && !flushStores && !newStores.io.deq.valid && allAcknowledged //Respond only once every store is acknowledged
+    advance := tryStore && !cycleOver && (!needsStore || newStores.io.enq.ready)
+
+    when(advance) {
+        remaining := remaining - steps
+        written := written + steps
+        lastSent := combinationStream
+        blockStep := Mux(blockStep === 56.U, 0.U, blockStep + 1.U)
+        when(blockStep =/= 0.U) {
+            codeBuffer := Mux(codeWordFull, 0.U, packedCodes)
+        }
+        packBuffer := Mux(packWordFull, packedBits >> 64, packedBits(63,0))
+        packFill := packFill + length(5,0)
+    }
+
+    //Start each delta stream with a keyframe, and empty the buffers once the last codes or bits are stored
+    when(io.cmd.fire()) {
+        remaining := Mux(io.cmd.bits.inst.funct(5), (1.U << ringLog) >> 1, io.cmd.bits.rs1(31,22) +& 1.U)
+        written := 0.U
+    }
+    when(io.cmd.fire() || (newStores.io.enq.fire() && cycleOver)) {
+        blockStep := 0.U
+        codeBuffer := 0.U
+        packBuffer := 0.U
+        packFill := 0.U
+    }
 
     //Switch out of memory mode when finished
     when(tryStore && finished) {
-	    state := s_resp
+	    state := Mux(asynchronous, s_flag, s_resp)
+    }
+
+    //Asynchronous functions then store the done word, with the top bit set over the response the function would
+    //have sent, and finish once it is acknowledged
+    val flagQueued = Reg(init = Bool(false))
+    when(flagging && newStores.io.enq.fire()) {
+        flagQueued := Bool(true)
+    }
+    when(flagging && flagQueued && !newStores.io.deq.valid && allAcknowledged) {
+        flagQueued := Bool(false)
+        state := Mux(ring && !sequenceOver, s_check, s_idle)
     }
 
+    //Ring functions store into a ring of slots after a head and a tail word at the address in rs2, with bits 26-22
+    //of rs1 holding the log of the number of slots. Each half of the ring is filled in turn, and the done word is
+    //the head, counting the strings stored so far, with the top bit set once the sequence is over. Before the next
+    //half is filled, the tail, counting the strings the processor has read, is loaded until that half has been read.
+    val ringSlots = 1.U(17.W) << ringLog
+    val ringHalf = ringSlots >> 1
+    val ringStart = doneAddress + 16.U
+    val ringEnd = ringStart + (ringSlots << 3)
+    val tailQueued = Reg(init = Bool(false))
+    when(checking && newStores.io.enq.fire()) {
+        tailQueued := Bool(true)
+    }
+    when(checking && io.mem.resp.valid && io.mem.resp.bits.has_data) {
+        tailQueued := Bool(false)
+        when(written - io.mem.resp.bits.data <= ringHalf) { //The processor has read the half about to be stored
+            state := s_busy
+            remaining := ringHalf
+            when(currentAddress === ringEnd) {
+                currentAddress := ringStart
+            }
+        }
+    }
+
+
+    //New stores
+    newStores.io.enq.valid := (tryStore && Mux(cycleOver, flushStores, needsStore)) || (flagging && !flagQueued) || (checking && !tailQueued)
+    newStores.io.enq.bits.addr := Mux(flagging, doneAddress, Mux(checking, doneAddress + 8.U, currentAddress))
+    newStores.io.enq.bits.cmd := Mux(checking, 0.U, 1.U) //Tail loads, then stores
+    val deltaData = Mux(blockStep === 0.U, combinationStream, Mux(cycleOver, codeBuffer, packedCodes))
+    val packData = Mux(cycleOver, packBuffer, packedBits(63,0))
+    val syncResponse = Mux(bounded, combinationStream(31,0), summedReturns(62,0)) //As functions 4-6 or 12-14 respond
+    val doneWord = Mux(ring, Cat(sequenceOver, written(62,0)), Cat(1.U(1.W), syncResponse))
+    newStores.io.enq.bits.data := Mux(flagging, doneWord, Mux(deltaStores, deltaData, Mux(packedStores, packData, Mux(grouped, groupData, combinationStream))))
+    newStores.io.enq.bits.size := Mux(flagging, 3.U, requestSize)
 
     //Memory request interface
-    io.mem.req.valid := tryStore && !cycleOver
-    io.busy := tryStore
-    io.mem.req.bits.addr := currentAddress
-    io.mem.req.bits.tag :=  combinationStream(5,0) //Change for out-of-order
-    io.mem.req.bits.cmd := 1.U
-    io.mem.req.bits.data := combinationStream //combinationStream
-    io.mem.req.bits.size := log2Ceil(8).U
+    val sending = newStores.io.deq.bits
+    io.mem.req.valid := newStores.io.deq.valid && tagReady
+    newStores.io.deq.ready := io.mem.req.ready && tagReady
+    newStoreSent := newStores.io.deq.fire()
+    io.busy := tryStore || flagging || checking
+    io.mem.req.bits.addr := sending.addr
+    io.mem.req.bits.tag := nextTag
+    io.mem.req.bits.cmd := sending.cmd
+    io.mem.req.bits.data := sending.data
+    io.mem.req.bits.size := sending.size
     io.mem.req.bits.signed := Bool(false)
     io.mem.req.bits.phys := Bool(false)
 
@@ -126,34 +365,241 @@ class CombinationsImp(outer: Combinations)(implicit p: Parameters) extends LazyR
 
 
 
+//Operations of the rank unit
+object rankOps {
+    def rank = 0.U(2.W) //Finds the rank of the string
+    def unrank = 1.U(2.W) //Finds the string at the rank in input
+    def jump = 2.U(2.W) //Finds the string input places after the string, or the done signal past the end
+}
+
+//A request for the rank unit, for a sequence with the same constraints as functions 0-2
+class RankRequest extends Bundle {
+    val op = UInt(2.W)
+    val kind = UInt(2.W)
+    val length = UInt(6.W)
+    val min = UInt(6.W)
+    val max = UInt(6.W)
+    val string = UInt(64.W)
+    val input = UInt(64.W)
+}
+
+//Ranks and unranks strings of each sequence over several cycles, following the software in tests/combinations.h.
+//Fixed-weight strings are ranked and unranked a bit per cycle. The cool-er and cool-est cycles are made of a block
+//per weight, so their strings are placed within their block a bit per cycle. The blocks are counted at once from a
+//ROM of the strings below each weight, and the block holding a rank is found by a binary search over the weights.
+//Binomials come from a ROM for lengths up to 32, so each operation takes tens of cycles.
+class RankUnit extends Module {
+    val io = new Bundle {
+        val req = Valid(new RankRequest).flip
+        val resp = Valid(UInt(64.W))
+    }
+    val s_idle :: s_rankBits :: s_position :: s_findWeight :: s_blockBits :: s_unrankBits :: s_done :: Nil = Enum(Bits(), 7)
+    val state = Reg(init = s_idle)
+
+    val table = Vec((0 to 32).flatMap(n => (0 to 32).map(k => binomialTable.choose(n, k).U(34.W))))
+    def binomial(n: UInt, k: UInt) : UInt = Mux(k > n, 0.U, table(n * 33.U + k))
+    val belowTable = Vec((0 to 32).flatMap(n => (0 to 33).map(k => binomialTable.below(n, k).U(34.W))))
+    def below(n: UInt, k: UInt) : UInt = belowTable(n * 34.U + k) //Strings of length n with fewer than k ones
+
+    //Request inputs
+    val op = Reg(UInt(2.W))
+    val kind = Reg(UInt(2.W))
+    val n = Reg(UInt(6.W))
+    val min = Reg(UInt(6.W))
+    val max = Reg(UInt(6.W))
+    val input = Reg(UInt(64.W))
+    val fixed = kind === 0.U
+    val general = kind === 1.U
+
+    //Working state
+    val string = Reg(UInt(64.W)) //The string being ranked, or built up while unranking
+    val i = Reg(UInt(6.W)) //The current bit
+    val w = Reg(UInt(7.W)) //The weight so far
+    val rank = Reg(UInt(64.W)) //The rank so far, within the string's block for cool-er and cool-est cycles
+    val pos = Reg(UInt(64.W)) //The position to find among the blocks
+    val result = Reg(UInt(64.W))
+
+    when(io.req.valid) {
+        op := io.req.bits.op
+        kind := io.req.bits.kind
+        n := io.req.bits.length
+        min := Mux(io.req.bits.kind === 1.U, 0.U, io.req.bits.min) //The cool-er cycle holds every weight
+        max := Mux(io.req.bits.kind === 1.U, io.req.bits.length, io.req.bits.max)
+        input := io.req.bits.input
+        string := io.req.bits.string
+        i := 0.U
+        w := 0.U
+        rank := 0.U
+        state := Mux(io.req.bits.op === rankOps.unrank, s_position, s_rankBits)
+    }
+
+    //Rank the string a bit at a time from the bottom, as rankWeightedCombination and rankCoolerBlock do
+    when(state === s_rankBits) {
+        when(string(i)) {
+            w := w + 1.U
+            when(fixed) {
+                when(i =/= 0.U) {
+                    rank := binomial(i, w + 1.U) + Mux(rank === 0.U, binomial(i, w) - 1.U, rank - 1.U)
+                }
+            } .otherwise {
+                rank := Mux(rank === 0.U, 0.U, binomial(i, w + 1.U) + rank)
+            }
+        } .elsewhen(!fixed && w =/= 0.U) {
+            rank := rank + 1.U
+        }
+        i := i + 1.U
+        when(i === n - 1.U) {
+            state := s_position
+        }
+    }
+
+    //Strings in the blocks heavier than a weight up to max, less the first of each
+    def heavier(weight: UInt) : UInt = Mux(weight < max, below(n, max + 1.U) - below(n, weight + 1.U) - (max - weight), 0.U)
+
+    //Turn the block position into a rank, then find the target rank's block, as coolestCyclePosition and
+    //coolestCycleString do. The cool-er cycle starts from all ones, at position n, and the cool-est cycle from the
+    //lowest min bits set.
+    val total = Mux(fixed, binomial(n, min), below(n, max + 1.U) - below(n, min))
+    val start = Mux(fixed || min === 0.U || min === n, Mux(general, n, 0.U), (max - min + 1.U) + heavier(min) + (n - min) - 1.U)
+    val cyclePosition = Mux(fixed, rank, Mux(rank === 0.U, w - min, (max - min + 1.U) + heavier(w) + rank - 1.U))
+    val found = Mux(cyclePosition >= start, cyclePosition - start, cyclePosition + total - start)
+    val target = Mux(op === rankOps.unrank, input, found +& input)
+    val shifted = target + start
+    val targetPosition = Mux(shifted >= total, shifted - total, shifted)
+    val firstWeight = (min + targetPosition(5,0))(5,0) //The weight of a string with its top bits set, early in the cycle
+    when(state === s_position) {
+        when(op === rankOps.rank) {
+            result := found
+            state := s_done
+        } .elsewhen(target >= total) {
+            result := nextCombination.doneSignal
+            state := s_done
+        } .elsewhen(fixed) {
+            rank := target
+            i := n - 1.U
+            w := min
+            string := 0.U
+            state := s_unrankBits
+        } .elsewhen(targetPosition <= max - min) {
+            result := ((1.U << firstWeight) - 1.U) << (n - firstWeight)
+            state := s_done
+        } .otherwise {
+            pos := targetPosition - (max - min + 1.U)
+            w := 0.U
+            i := 5.U
+            state := s_findWeight
+        }
+    }
+
+    //Find the block holding the target position a bit of its weight at a time, as the heaviest weight with more
+    //strings in the blocks above it than the position
+    when(state === s_findWeight) {
+        val candidate = w | (1.U << i(2,0))
+        val heaviest = Mux(candidate <= max && heavier(candidate - 1.U) > pos, candidate, w)
+        w := heaviest
+        i := i - 1.U
+        when(i === 0.U) {
+            rank := pos - heavier(heaviest) + 1.U
+            i := n - 1.U
+            string := 0.U
+            state := s_blockBits
+        }
+    }
+
+    //Build the string within its block a bit at a time from the top, as unrankCoolerBlock does
+    when(state === s_blockBits) {
+        when(w === 0.U) {
+            result := string
+            state := s_done
+        } .elsewhen(w === i + 1.U) { //Only ones remain
+            result := string | ((1.U << w) - 1.U)
+            state := s_done
+        } .otherwise {
+            val c = binomial(i, w)
+            when(rank === 0.U || rank > c) {
+                string := string | (1.U << i)
+                w := w - 1.U
+                rank := Mux(rank === 0.U, 0.U, rank - c)
+            } .otherwise {
+                rank := rank - 1.U
+            }
+            i := i - 1.U
+        }
+    }
+
+    //Build a fixed-weight string a bit at a time from the top, as unrankWeightedCombination does
+    when(state === s_unrankBits) {
+        when(w === 0.U) {
+            result := string
+            state := s_done
+        } .otherwise {
+            val zeros = binomial(i, w)
+            val left = rank - zeros
+            when(rank >= zeros) {
+                string := string | (1.U << i)
+                w := w - 1.U
+                rank := Mux(w =/= 1.U && i =/= 0.U, Mux(left + 1.U === binomial(i, w - 1.U), 0.U, left + 1.U), 0.U)
+            }
+            i := i - 1.U
+        }
+    }
+
+    io.resp.valid := state === s_done
+    io.resp.bits := result
+    when(state === s_done) {
+        state := s_idle
+    }
+}
+
+//Binomials for the rank unit's ROM
+object binomialTable {
+    def choose(n: Int, k: Int) : BigInt = if(k < 0 || k > n) BigInt(0) else (0 until k).foldLeft(BigInt(1))((c, j) => c * (n - j) / (j + 1))
+    def below(n: Int, k: Int) : BigInt = (0 until k).map(choose(n, _)).sum
+}
+
+//A store, or the load of a ring's tail, waiting to be sent to the cache, which gives it a tag once sent
+class MemoryRequest extends Bundle {
+    val addr = UInt(64.W)
+    val cmd = UInt(5.W)
+    val data = UInt(64.W)
+    val size = UInt(2.W)
+}
+
 //Generates binary string combinations based on input constraints and saves them to memory.
 object memoryAccess {
     //Depending on the type for cycleCombinations, a different combination pattern will be used.
-    def cycleCombinations(constraints: UInt, getNext: Bool, reset: Bool, kind: Int) : UInt = {
+    //The successor logic is chained once per lane, so the strings for every lane are ready in the same cycle,
+    //and the cycle moves forward by the given number of steps when the next values are requested.
+    //A bounded cycle starts from the string in bits 63-32 of the constraints instead of the first one.
+    def cycleCombinations(constraints: UInt, getNext: Bool, reset: Bool, kind: Int, lanes: Int, steps: UInt, bounded: Bool,
+            ranged: Bool, start: UInt, end: UInt) : Vec[UInt] = {
         val initial = Wire(UInt(64.W)) //The first value of the cycle
         if(kind == 1) { //The general cycle starts and ends with all 1s
-            initial := (1.U << constraints(5,0)) - 1.U
+            initial := Mux(bounded, constraints(63,32), Mux(ranged, start, (1.U << constraints(5,0)) - 1.U))
         } else { //The other cycles start with lower 1s filled according to allowed weights
-            initial := (1.U << constraints(11,6)) - 1.U
+            initial := Mux(bounded, constraints(63,32), Mux(ranged, start, (1.U << constraints(11,6)) - 1.U))
         }
+        def stop(string: UInt) : UInt = Mux(string === end, nextCombination.doneSignal, string) //A range ends before its end string
 
         val nextSent = Reg(UInt(64.W)) //The value currently saved for storing to memory
-        val result = kind match { //Calculate next value as the last is being stored
-            case 0 => nextCombination.fixedWeight(constraints(5,0), nextSent)
-            case 1 => nextCombination.generalCombinations(constraints(5,0), nextSent)
-            case 2 => nextCombination.rangedCombinations(constraints(5,0), nextSent, constraints(11,6), constraints(17,12))
+        def successor(previous: UInt) : UInt = kind match { //Calculate next values as the last are being stored
+            case 0 => nextCombination.fixedWeight(constraints(5,0), previous)
+            case 1 => nextCombination.generalCombinations(constraints(5,0), previous)
+            case 2 => nextCombination.rangedCombinations(constraints(5,0), previous, constraints(11,6), constraints(17,12))
         }
+        //Once the cycle is over, every later lane is over too
+        val results = (0 until lanes).scanLeft(nextSent)((previous, lane) => Mux(previous === nextCombination.doneSignal, previous, stop(successor(previous))))
 
-        //Cycle by one when next value requested
+        //Cycle by the number of strings used when next values requested
         when(getNext) {
-    	  nextSent := result
+    	  nextSent := Vec(results.tail)(steps - 1.U)
     	}
 
         //Start new cycle of the requested length when a reset is requested
     	when(reset) {
-    	  nextSent := initial
+    	  nextSent := stop(initial)
     	}
-    	nextSent
+    	Vec(results.init)
     }
 }
 
@@ -239,10 +685,34 @@ object nextCombination {
     }
 }
 
-//Setup for the accelerator
-class WithCombinations extends Config((site, here, up) => {
+//These methods find the one-byte codes that describe each step of a sequence, for delta-encoded stores.
+//Every step rotates the bits from bit 0 up to a top bit by one position, and the code holds that top bit.
+object deltaCode {
+    //Cool-lex steps rotate up, moving the top bit to bit 0, and the top bit is the highest bit to change
+    def fixedWeight(previous: UInt, next: UInt) : UInt = {
+        Log2(previous ^ next)
+    }
+
+    //Cool-er and cool-est steps rotate down to the end of the first '01' above bit 0, or else the string's final bit.
+    //Bit 6 is set when the bit moved from bit 0 to the top is flipped.
+    def rotateDown(length: UInt, previous: UInt, next: UInt) : UInt = {
+        val trimmed = previous(31,1) | (previous(31,1) - 1.U) //Remove trailing 0s
+        val trailed = trimmed ^ (trimmed + 1.U) //Make a mask for the right-most '01' onwards
+        val lastTemp = Wire(UInt(32.W))
+        lastTemp := trailed + 1.U //If there is a valid '01', this is the top bit
+        val lastLimit = 1.U << (length(5,0) - 1.U) //Otherwise use the string's final bit
+        val top = OHToUInt(Mux(lastTemp > lastLimit || lastTemp === 0.U, lastLimit, lastTemp))
+
+        val flipped = (next >> top)(0) =/= previous(0) //Whether the moved bit changed
+        Cat(flipped, top(5,0))
+    }
+}
+
+//Setup for the accelerator, which finds one string per cycle in each of its lanes when storing to memory,
+//with up to inFlight stores waiting on the cache, a number of cursor contexts, and lanes for elements of storeBytes
+class WithCombinations(lanes: Int = 1, inFlight: Int = 2, contexts: Int = 4, storeBytes: Int = 8) extends Config((site, here, up) => {
     case BuildRoCC => Seq((p: Parameters) => {
-        val Combinations = LazyModule.apply(new Combinations(OpcodeSet.custom0) (p))
+        val Combinations = LazyModule.apply(new Combinations(OpcodeSet.custom0, lanes, inFlight, contexts, storeBytes) (p))
         Combinations
     })
 })
@@ -259,4 +729,15 @@ class CombinationsRocketConfig extends Config(
     new freechips.rocketchip.system.BaseConfig
 )
 
+ * For tests/coreTests.c, every core gets its own accelerator, so each hart can store a slice of a sequence:
+
+class CombinationsQuadRocketConfig extends Config(
+    new WithTop ++
+    new WithBootROM ++
+    new freechips.rocketchip.subsystem.WithInclusiveCache ++
+    new combinations.WithCombinations ++
+    new freechips.rocketchip.subsystem.WithNBigCores(4) ++
+    new freechips.rocketchip.system.BaseConfig
+)
+
  */
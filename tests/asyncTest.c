@@ -0,0 +1,110 @@
+// Tests for the asynchronous memory functions, checking one chunk while the next is stored
+// (c) Maddie Burbage, 2020
+
+#include "rocc.h"
+#include "combinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIZE 256 //Strings in each chunk
+
+//The done word comes first, then the strings
+static unsigned long buffers[2][SIZE + 1];
+
+//Starts an asynchronous bounded function storing a chunk after a done word
+static void startChunk(const struct sequence *s, unsigned long constraints, unsigned long start, unsigned long *buffer) {
+    unsigned long response;
+
+    buffer[0] = 0;
+    asm volatile ("fence");
+    switch(s->kind) {
+    case FIXED_WEIGHT: ROCC_INSTRUCTION_DSS(0, response, constraints | CHUNK_CONSTRAINTS(SIZE, start), buffer, 12 + ASYNC); break;
+    case GENERAL: ROCC_INSTRUCTION_DSS(0, response, constraints | CHUNK_CONSTRAINTS(SIZE, start), buffer, 13 + ASYNC); break;
+    default: ROCC_INSTRUCTION_DSS(0, response, constraints | CHUNK_CONSTRAINTS(SIZE, start), buffer, 14 + ASYNC);
+    }
+    if(response != 0) {
+        printf("Asynchronous response: %lx\n", response);
+    }
+}
+
+/* Stores a whole sequence in chunks through two buffers. While the
+ * accelerator stores each chunk, the one before it is checked against the
+ * software sequence.
+ */
+static int testDoubleBuffered(const struct sequence *s) {
+    unsigned long constraints, next, string, stored, total = 0, index;
+    unsigned int following = 0;
+    int current = 0, mismatches = 0;
+
+    constraints = s->length | (s->min << 6) | (s->max << 12);
+    string = sequenceString(s, 0);
+    startChunk(s, constraints, string, buffers[current]);
+    do {
+        next = waitCombinations(&buffers[current][0]);
+        if(next != CHUNK_DONE) { //Start the next chunk before checking this one
+            startChunk(s, constraints, next, buffers[current ^ 1]);
+        }
+        stored = (next == CHUNK_DONE)? sequenceLength(s) - total : SIZE;
+        for(index = 0; index < stored; index++) {
+            if(buffers[current][index + 1] != string) {
+                mismatches++;
+            }
+            sequenceNext(s, string, &following);
+            string = following;
+        }
+        if(next != CHUNK_DONE && next != string) {
+            printf("ERROR: kind %d chunk at %lu\n", s->kind, total);
+            mismatches++;
+        }
+        total += stored;
+        current ^= 1;
+    } while(next != CHUNK_DONE && total < sequenceLength(s));
+    return mismatches;
+}
+
+/* Stores a whole sequence with an asynchronous function 4-6, then waits on
+ * the done word and checks the strings.
+ */
+static int testWhole(const struct sequence *s, unsigned long *buffer) {
+    unsigned long constraints, index, string, response;
+    unsigned int next = 0;
+    int mismatches = 0;
+
+    constraints = s->length | (s->min << 6) | (s->max << 12);
+    buffer[0] = 0;
+    asm volatile ("fence");
+    switch(s->kind) {
+    case FIXED_WEIGHT: ROCC_INSTRUCTION_DSS(0, response, constraints, buffer, 4 + ASYNC); break;
+    case GENERAL: ROCC_INSTRUCTION_DSS(0, response, constraints, buffer, 5 + ASYNC); break;
+    default: ROCC_INSTRUCTION_DSS(0, response, constraints, buffer, 6 + ASYNC);
+    }
+    waitCombinations(&buffer[0]);
+    if(response != 0) {
+        mismatches++;
+    }
+    string = sequenceString(s, 0);
+    for(index = 0; index < sequenceLength(s); index++) {
+        if(buffer[index + 1] != string) {
+            mismatches++;
+        }
+        sequenceNext(s, string, &next);
+        string = next;
+    }
+    return mismatches;
+}
+
+int main(void) {
+    struct sequence sequences[] = {{FIXED_WEIGHT, 12, 6, 6}, {GENERAL, 11, 0, 11}, {RANGED, 12, 3, 7}};
+    static unsigned long whole[1 << 12];
+    unsigned int i;
+    int mismatches = 0;
+
+    for(i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        mismatches += testDoubleBuffered(&sequences[i]);
+    }
+    //Fits the 2^11 strings and the done word
+    mismatches += testWhole(&sequences[1], whole);
+    printf("Asynchronous mismatches: %d\n", mismatches);
+    return mismatches;
+}
@@ -0,0 +1,103 @@
+// Tests for the bulk software generation functions
+// (c) Maddie Burbage, 2020
+
+#include "combinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK 7 //An awkward chunk size, so sequences end partway through a chunk
+
+//Follows along with the successor to check each string visited
+struct walk {
+    struct sequence sequence;
+    unsigned long expected;
+    unsigned long visited;
+    int mismatches;
+};
+
+static void checkString(void *context, unsigned long string) {
+    struct walk *w = context;
+    unsigned int next;
+
+    if(string != w->expected) {
+        w->mismatches++;
+    }
+    w->visited++;
+    if(sequenceNext(&w->sequence, string, &next) != -1) {
+        w->expected = next;
+    }
+}
+
+/* Compares visiting a whole sequence, and filling it in chunks, with the
+ * successor loop. The chunks are resumed from the state each time.
+ */
+static int testSequence(const struct sequence *s) {
+    struct walk w;
+    struct sequenceState state;
+    unsigned long buffer[CHUNK], count, written, i, expected;
+    unsigned int next;
+    int mismatches = 0;
+
+    count = sequenceLength(s);
+    w.sequence = *s;
+    w.expected = sequenceString(s, 0);
+    w.visited = 0;
+    w.mismatches = 0;
+    if(visitCombinations(s, checkString, &w) != count || w.visited != count) {
+        mismatches++;
+    }
+    mismatches += w.mismatches;
+
+    startCombinations(&state, s, 0);
+    expected = sequenceString(s, 0);
+    i = 0;
+    while((written = fillCombinations(buffer, CHUNK, &state)) > 0) {
+        for(count = 0; count < written; count++, i++) {
+            if(buffer[count] != expected) {
+                mismatches++;
+            }
+            if(sequenceNext(s, expected, &next) != -1) {
+                expected = next;
+            }
+        }
+    }
+    if(i != sequenceLength(s)) {
+        printf("ERROR: kind %d length %ld filled %lu strings\n", s->kind, s->length, i);
+        mismatches++;
+    }
+
+    //Resuming from a rank partway through fills the rest of the sequence
+    startCombinations(&state, s, sequenceLength(s) / 2);
+    written = 0;
+    while((count = fillCombinations(buffer, CHUNK, &state)) > 0) {
+        written += count;
+    }
+    if(written != sequenceLength(s) - sequenceLength(s) / 2) {
+        mismatches++;
+    }
+    return mismatches;
+}
+
+int main(void) {
+    struct sequence s;
+    long n;
+    int mismatches = 0;
+
+    for(n = 1; n <= 16; n++) {
+        s.length = n;
+        s.kind = FIXED_WEIGHT;
+        s.min = s.max = n/2 + 1;
+        mismatches += testSequence(&s);
+        s.kind = GENERAL;
+        s.min = 0;
+        s.max = n;
+        mismatches += testSequence(&s);
+        s.kind = RANGED;
+        s.min = n/3;
+        s.max = n/2 + 1;
+        mismatches += testSequence(&s);
+    }
+    printf("Bulk generation mismatches: %d\n", mismatches);
+    return mismatches;
+}
@@ -0,0 +1,69 @@
+// Tests for the bounded memory functions, which store a sequence in chunks
+// (c) Maddie Burbage, 2020
+
+#include "rocc.h"
+#include "combinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GUARD 0xa5a5a5a5a5a5a5a5 //Fills the buffer before each chunk
+
+static unsigned long buffer[CHUNK_STRINGS + 1];
+
+/* Has the accelerator store a whole sequence in chunks of a given size,
+ * reusing one buffer, and checks each chunk against the software sequence.
+ * The string returned for each chunk starts the next one.
+ */
+static int testChunks(const struct sequence *s, unsigned long size) {
+    unsigned long constraints, start, stored, total = 0, index, string;
+    unsigned int next = 0;
+    int mismatches = 0;
+
+    constraints = s->length | (s->min << 6) | (s->max << 12);
+    start = string = sequenceString(s, 0);
+    while(start != CHUNK_DONE) {
+        for(index = 0; index <= CHUNK_STRINGS; index++) {
+            buffer[index] = GUARD;
+        }
+        asm volatile ("fence");
+        switch(s->kind) {
+        case FIXED_WEIGHT: ROCC_INSTRUCTION_DSS(0, start, constraints | CHUNK_CONSTRAINTS(size, start), &buffer[0], 12); break;
+        case GENERAL: ROCC_INSTRUCTION_DSS(0, start, constraints | CHUNK_CONSTRAINTS(size, start), &buffer[0], 13); break;
+        default: ROCC_INSTRUCTION_DSS(0, start, constraints | CHUNK_CONSTRAINTS(size, start), &buffer[0], 14);
+        }
+
+        stored = (start == CHUNK_DONE)? sequenceLength(s) - total : size;
+        for(index = 0; index < stored; index++) {
+            if(buffer[index] != string) {
+                mismatches++;
+            }
+            sequenceNext(s, string, &next);
+            string = next;
+        }
+        if(buffer[stored] != GUARD || (start != CHUNK_DONE && start != string)) {
+            printf("ERROR: kind %d chunk of %lu at %lu\n", s->kind, size, total);
+            mismatches++;
+        }
+        total += stored;
+        if(stored > size || total > sequenceLength(s)) {
+            return mismatches + 1;
+        }
+    }
+    return mismatches;
+}
+
+int main(void) {
+    struct sequence sequences[] = {{FIXED_WEIGHT, 12, 6, 6}, {GENERAL, 12, 0, 12}, {RANGED, 12, 3, 7}};
+    unsigned long sizes[] = {1, 7, 100, CHUNK_STRINGS};
+    unsigned int i, j;
+    int mismatches = 0;
+
+    for(i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        for(j = 0; j < sizeof(sizes) / sizeof(sizes[0]); j++) {
+            mismatches += testChunks(&sequences[i], sizes[j]);
+        }
+    }
+    printf("Chunk mismatches: %d\n", mismatches);
+    return mismatches;
+}
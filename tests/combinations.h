@@ -0,0 +1,526 @@
+// Software versions of the combination sequences, with ranking and unranking
+// (c) Maddie Burbage, 2020
+
+#ifndef __COMBINATIONS_H
+#define __COMBINATIONS_H
+
+#define LONGTOP 0x8000000000000000
+#define MAX_WIDTH 32
+#define STORE_BYTES(bytes) ((long) (3 - __builtin_ctz(bytes)) << 20) //Set in register 1 for functions 4-6 to store 1, 2, 4 or 8 bytes per string
+#define CHUNK_STRINGS 1024 //The most strings functions 12-14 store in one call
+#define START_STRING(start) ((long) (start) << 32) //Set in register 1 for the functions that start from a given string
+#define CHUNK_CONSTRAINTS(count, start) ((long) ((count) - 1) << 22 | START_STRING(start)) //Set in register 1 for functions 12-14 to store count strings from start
+#define CHUNK_DONE 0xffffffffUL //Returned by functions 12-14 once the sequence has ended
+#define ASYNC 16 //Added to functions 4-6 and 12-14 to respond at once and set a done word when finished
+#define CURSOR_OPEN 64 //Added to functions 0-2 to open a cursor, named by register 2, on their sequence
+#define CURSOR_NEXT 67 //Steps the cursor named by register 2 to its next string
+#define JUMP_AHEAD 8 //Added to functions 0-2 to find the string a number of places, in register 2, after a start string
+#define RANK 3 //Finds the position of the string in register 2
+#define UNRANK 7 //Finds the string at the position in register 2
+#define RANK_KIND(kind) ((long) (kind) << 18) //Set in register 1 for functions 3 and 7 to pick the kind of sequence, in the bits that hold the store format for functions 4-6
+#define RANGE 11 //Sets the string the next function 4-6 starts from, in register 1, and stops before, in register 2
+#define RANGE_END 0xffffffffUL //Set in register 2 for function 11 to run to the end of the sequence
+
+/* Returns n choose k for strings up to MAX_WIDTH bits long. The table of
+ * binomials is filled by Pascal's rule on the first call.
+ */
+static inline unsigned long binomial(long n, long k) {
+    static unsigned long table[MAX_WIDTH + 1][MAX_WIDTH + 1];
+    static int filled = 0;
+    long i, j;
+
+    if(!filled) {
+        for(i = 0; i <= MAX_WIDTH; i++) {
+            table[i][0] = 1;
+            for(j = 1; j <= i; j++) {
+                table[i][j] = table[i-1][j-1] + ((j < i)? table[i-1][j] : 0);
+            }
+        }
+        filled = 1;
+    }
+
+    if(k < 0 || k > n) {
+        return 0;
+    }
+    return table[n][k];
+}
+
+/* A function to help generate all binary strings of a certain weight.
+ * Input the length of the binary string and the previous combination.
+ * The pointer, out, will be loaded with the next combination following
+ * the suffix-rotation pattern. -1 is returned when the pattern ends.
+ * Generation is computed using Knuth's variant on the cool pattern from
+ * The Art of Computer Programming, volume 4, fascicle 3.
+ */
+static inline int stepWeightedCombination(long n, unsigned long last, unsigned int *out) {
+    unsigned long next, temp, result;
+    next = last & (last + 1); //Discards trailing ones
+    temp = next ^ (next - 1); //Marks the start of the last "10"
+
+    next = temp + 1;
+    temp = temp & last;
+
+    next = (next & last) - 1;
+
+    next = (next < LONGTOP)? next : 0;
+
+    result = last + temp - next;
+
+    if(result / (1L << n) > 0) {
+        return -1;
+    }
+
+    *out = result % (1L << n);
+    return 1;
+}
+
+/* A function to help generate all binary strings of a certain length.
+ * The generation is computed using the cool-er pattern from "The Coolest
+ * Way to Generate Binary Strings"
+ */
+static inline int stepGeneralCombination(long n, unsigned long last, unsigned int *out) {
+  unsigned long cut, trimmed, trailed, mask, lastTemp, lastLimit, lastPosition, cap, first, shifted, rotated, result;
+
+    cut = last >> 1;
+    trimmed = cut | (cut - 1); //Discards trailing zeros
+    trailed = trimmed ^ (trimmed + 1); //Marks the start of the last "01"
+    mask = (trailed << 1) + 1;
+
+    lastTemp = trailed + 1; //Indexes the start of the last "01"
+    lastLimit = 1L << (n-1); //Indexes the length of the string
+    lastPosition = (lastTemp == 0 || lastTemp > lastLimit)? lastLimit : lastTemp;
+
+    cap = 1L << n;
+    first = (mask < cap)? 1 & last : 1 & ~(last); //The bit to be moved
+    shifted = cut & trailed;
+    rotated = (first == 1)? shifted | lastPosition : shifted;
+    result = rotated | (~mask & last);
+
+    if(result == cap - 1) {
+        return -1;
+    }
+
+    *out = result;
+    return 1;
+}
+
+/* A function to help generate all binary strings of a certain length and weight range
+ * The generation is computed using the cool-est pattern from "The Coolest
+ * Way to Generate Binary Strings"
+ */
+static inline int stepRangedCombination(long n, unsigned long last, long min, long max, unsigned int *out) {
+  unsigned long cut, trimmed, trailed, mask, lastTemp, lastLimit, lastPosition, disposable, count, cap, flipped, valid, first, shifted, rotated, result;
+    cut = last >> 1;
+    trimmed = cut | (cut - 1); //Discards trailing zeros
+    trailed = trimmed ^ (trimmed + 1); //Marks the start of the last "01"
+    mask = (trailed << 1) + 1;
+
+    lastTemp = trailed + 1; //Indexes the start of the last "01"
+    lastLimit = 1L << (n-1); //Indexes the length of the string
+    lastPosition = (lastTemp == 0 || lastTemp > lastLimit)? lastLimit : lastTemp;
+
+    disposable = last; //Prepare to count bits set in the string
+    for(count = 0; disposable; count++) {
+        disposable = disposable & (disposable - 1); //Discard the last bit set
+    }
+
+    cap = 1L << n;
+    flipped = 1 & ~last;
+    valid = (flipped == 0)? count > min : count < max;
+    first = (mask < cap || !valid)? 1 & last : flipped; //The bit to be moved
+    shifted = cut & trailed;
+    rotated = (first == 1)? shifted | lastPosition : shifted;
+    result = rotated | (~mask & last);
+
+    cap = (1L << min) - 1;
+    if(result == cap) {
+        return -1;
+    }
+
+    *out = result;
+    return 1;
+}
+
+/* The successors above are kept out of line when called by these names, as
+ * they were in timeTests.c, so the software timings keep measuring a call per
+ * string. Loops that want the successor inlined call the step versions.
+ */
+static __attribute__((noinline, unused)) int nextWeightedCombination(long n, unsigned long last, unsigned int *out) {
+    return stepWeightedCombination(n, last, out);
+}
+
+static __attribute__((noinline, unused)) int nextGeneralCombination(long n, unsigned long last, unsigned int *out) {
+    return stepGeneralCombination(n, last, out);
+}
+
+static __attribute__((noinline, unused)) int nextRangedCombination(long n, unsigned long last, long min, long max, unsigned int *out) {
+    return stepRangedCombination(n, last, min, max, out);
+}
+
+/* Finds the position of a fixed-weight string in the cool-lex sequence that
+ * nextWeightedCombination walks, starting from (1 << k) - 1 at rank 0.
+ * The cool-lex list of length n and weight k is the list for length n-1 and
+ * weight k with a 0 appended, followed by the list for length n-1 and weight
+ * k-1 with a 1 appended and its first string moved to the end. Ranks are
+ * built up one prefix at a time, so this takes O(n) steps.
+ */
+static inline unsigned long rankWeightedCombination(long n, unsigned long string) {
+    unsigned long rank = 0;
+    long i, weight = 0;
+
+    for(i = 0; i < n; i++) {
+        if((string >> i) & 1) {
+            weight++;
+            if(i > 0) { //The prefix moves into the block of strings ending in 1
+                rank = binomial(i, weight) + (rank + binomial(i, weight - 1) - 1) % binomial(i, weight - 1);
+            }
+        }
+    }
+    return rank;
+}
+
+/* Finds the string of length n and weight k at the given position of the
+ * cool-lex sequence, undoing rankWeightedCombination one bit at a time from
+ * the top of the string.
+ */
+static inline unsigned long unrankWeightedCombination(long n, long k, unsigned long rank) {
+    unsigned long string = 0;
+    unsigned long zeros;
+    long i;
+
+    for(i = n - 1; i >= 0 && k > 0; i--) {
+        zeros = binomial(i, k); //Strings of this prefix length ending in 0
+        if(rank >= zeros) {
+            string |= 1L << i;
+            rank -= zeros;
+            k--;
+            rank = (k > 0 && i > 0)? (rank + 1) % binomial(i, k) : 0;
+        }
+    }
+    return string;
+}
+
+/* Finds the position of a string within its weight's block of the cool-er
+ * and cool-est sequences. A block starts with the string whose top bits are
+ * set, and the block for length n and weight w is that string, then the block
+ * for length n-1 and weight w with a 0 appended, then the rest of the block for
+ * length n-1 and weight w-1 with a 1 appended. Takes O(n) steps.
+ */
+static inline unsigned long rankCoolerBlock(long n, unsigned long string) {
+    unsigned long rank = 0;
+    long i, weight = 0;
+
+    for(i = 0; i < n; i++) {
+        if((string >> i) & 1) {
+            weight++;
+            rank = (rank == 0)? 0 : binomial(i, weight) + rank;
+        } else if(weight > 0) {
+            rank++; //Skip the string with the top bits set
+        }
+    }
+    return rank;
+}
+
+/* Finds the string of length n and weight w at a position within its block,
+ * undoing rankCoolerBlock one bit at a time from the top of the string.
+ */
+static inline unsigned long unrankCoolerBlock(long n, long w, unsigned long rank) {
+    unsigned long string = 0;
+    long i;
+
+    for(i = n - 1; i >= 0 && w > 0; i--) {
+        if(w == i + 1) { //Only ones remain
+            string |= (1L << w) - 1;
+            break;
+        }
+        if(rank == 0) {
+            string |= 1L << i;
+            w--;
+        } else if(rank <= binomial(i, w)) {
+            rank--;
+        } else {
+            string |= 1L << i;
+            rank -= binomial(i, w);
+            w--;
+        }
+    }
+    return string;
+}
+
+/* Finds the position of a string in the full cycle of strings with weights
+ * from min to max. The cycle first visits the strings with the top min to max
+ * bits set, then each weight's block without its first string, from the
+ * highest weight down to the lowest.
+ */
+static inline unsigned long coolestCyclePosition(long n, unsigned long string, long min, long max) {
+    unsigned long block, position, disposable;
+    long weight, w;
+
+    block = rankCoolerBlock(n, string);
+    disposable = string; //Prepare to count bits set in the string
+    for(weight = 0; disposable; weight++) {
+        disposable = disposable & (disposable - 1); //Discard the last bit set
+    }
+
+    if(block == 0) {
+        return weight - min;
+    }
+    position = max - min + 1;
+    for(w = max; w > weight; w--) {
+        position += binomial(n, w) - 1;
+    }
+    return position + block - 1;
+}
+
+/* Finds the string at a position in the full cycle of weights min to max.
+ */
+static inline unsigned long coolestCycleString(long n, unsigned long position, long min, long max) {
+    long w;
+
+    if(position <= max - min) {
+        w = min + position;
+        return ((1L << w) - 1) << (n - w);
+    }
+    position -= max - min + 1;
+    for(w = max; position >= binomial(n, w) - 1; w--) {
+        position -= binomial(n, w) - 1;
+    }
+    return unrankCoolerBlock(n, w, position + 1);
+}
+
+/* Finds the position of a string in the cool-er sequence that
+ * nextGeneralCombination walks, starting from all ones at rank 0.
+ */
+static inline unsigned long rankGeneralCombination(long n, unsigned long string) {
+    unsigned long cap = 1L << n;
+    return (coolestCyclePosition(n, string, 0, n) + cap - n) % cap; //All ones are at cycle position n
+}
+
+/* Finds the string of length n at the given position of the cool-er sequence.
+ */
+static inline unsigned long unrankGeneralCombination(long n, unsigned long rank) {
+    return coolestCycleString(n, (rank + n) % (1L << n), 0, n);
+}
+
+/* Counts the strings of length n with weights from min to max, which is the
+ * length of the cool-est sequence that nextRangedCombination walks.
+ */
+static inline unsigned long countRangedCombinations(long n, long min, long max) {
+    unsigned long count = 0;
+    long w;
+
+    for(w = min; w <= max; w++) {
+        count += binomial(n, w);
+    }
+    return count;
+}
+
+/* Finds the position of a string in the cool-est sequence that
+ * nextRangedCombination walks, starting from (1 << min) - 1 at rank 0.
+ */
+static inline unsigned long rankRangedCombination(long n, unsigned long string, long min, long max) {
+    unsigned long count, start;
+
+    count = countRangedCombinations(n, min, max);
+    start = coolestCyclePosition(n, (1L << min) - 1, min, max);
+    return (coolestCyclePosition(n, string, min, max) + count - start) % count;
+}
+
+/* Finds the string of length n at the given position of the cool-est sequence
+ * with weights from min to max.
+ */
+static inline unsigned long unrankRangedCombination(long n, unsigned long rank, long min, long max) {
+    unsigned long count, start;
+
+    count = countRangedCombinations(n, min, max);
+    start = coolestCyclePosition(n, (1L << min) - 1, min, max);
+    return coolestCycleString(n, (rank + start) % count, min, max);
+}
+
+//Which sequence to generate, numbered like the accelerator's function codes
+enum { FIXED_WEIGHT = 0, GENERAL = 1, RANGED = 2 };
+
+struct sequence {
+    int kind;
+    long length;
+    long min; //The weight for fixed-weight sequences
+    long max;
+};
+
+/* Called once per string generated by visitCombinations */
+typedef void (*combinationVisitor)(void *context, unsigned long string);
+
+//A position in a sequence, for generating it in resumable chunks
+struct sequenceState {
+    struct sequence sequence;
+    unsigned long string; //The next string to generate
+    int done;
+};
+
+/* Counts the strings in a sequence */
+static inline unsigned long sequenceLength(const struct sequence *s) {
+    switch(s->kind) {
+    case FIXED_WEIGHT: return binomial(s->length, s->min);
+    case GENERAL: return 1L << s->length;
+    default: return countRangedCombinations(s->length, s->min, s->max);
+    }
+}
+
+/* Finds the string at a rank of a sequence */
+static inline unsigned long sequenceString(const struct sequence *s, unsigned long rank) {
+    switch(s->kind) {
+    case FIXED_WEIGHT: return unrankWeightedCombination(s->length, s->min, rank);
+    case GENERAL: return unrankGeneralCombination(s->length, rank);
+    default: return unrankRangedCombination(s->length, rank, s->min, s->max);
+    }
+}
+
+/* Steps a sequence forward by one string with the matching successor */
+static inline int sequenceNext(const struct sequence *s, unsigned long last, unsigned int *out) {
+    switch(s->kind) {
+    case FIXED_WEIGHT: return nextWeightedCombination(s->length, last, out);
+    case GENERAL: return nextGeneralCombination(s->length, last, out);
+    default: return nextRangedCombination(s->length, last, s->min, s->max, out);
+    }
+}
+
+/* Finds the rank of a string of a sequence */
+static inline unsigned long sequenceRank(const struct sequence *s, unsigned long string) {
+    switch(s->kind) {
+    case FIXED_WEIGHT: return rankWeightedCombination(s->length, string);
+    case GENERAL: return rankGeneralCombination(s->length, string);
+    default: return rankRangedCombination(s->length, string, s->min, s->max);
+    }
+}
+
+/* Splits a sequence into a number of slices of nearly equal length, and finds
+ * the string a slice starts from and the string it stops before, to be set
+ * with function 11. The last slice runs to the end of the sequence.
+ */
+static inline void sequenceSlice(const struct sequence *s, unsigned long slice, unsigned long slices, unsigned long *start, unsigned long *end) {
+    unsigned long length = sequenceLength(s);
+
+    *start = sequenceString(s, length * slice / slices);
+    *end = (slice + 1 == slices)? RANGE_END : sequenceString(s, length * (slice + 1) / slices);
+}
+
+/* Generates every string of a sequence in one loop, calling visit on each.
+ * The loop for each kind is written out separately and the successor is
+ * inlined into it, so the string stays in a register between steps. When
+ * visit is a known function the compiler inlines it as well. Returns the
+ * number of strings visited.
+ */
+static inline __attribute__((flatten)) unsigned long visitCombinations(const struct sequence *s, combinationVisitor visit, void *context) {
+    unsigned long string, visited = 1;
+    unsigned int next = 0;
+    long n = s->length, min = s->min, max = s->max;
+
+    string = sequenceString(s, 0);
+    visit(context, string);
+    switch(s->kind) {
+    case FIXED_WEIGHT:
+        while(stepWeightedCombination(n, string, &next) != -1) {
+            string = next;
+            visit(context, string);
+            visited++;
+        }
+        break;
+    case GENERAL:
+        while(stepGeneralCombination(n, string, &next) != -1) {
+            string = next;
+            visit(context, string);
+            visited++;
+        }
+        break;
+    default:
+        while(stepRangedCombination(n, string, min, max, &next) != -1) {
+            string = next;
+            visit(context, string);
+            visited++;
+        }
+    }
+    return visited;
+}
+
+/* Sets up a state to generate a sequence from the string at a rank.
+ */
+static inline void startCombinations(struct sequenceState *state, const struct sequence *s, unsigned long rank) {
+    state->sequence = *s;
+    state->done = rank >= sequenceLength(s);
+    state->string = state->done? 0 : sequenceString(s, rank);
+}
+
+/* Moves a state k strings further along its sequence by ranking its string
+ * and unranking the rank k places later, without stepping through the
+ * strings between. Returns 0, or -1 when that passes the end of the
+ * sequence, which leaves the state done.
+ */
+static inline int advanceCombinations(struct sequenceState *state, unsigned long k) {
+    unsigned long rank, length = sequenceLength(&state->sequence);
+
+    if(state->done) {
+        return -1;
+    }
+    rank = sequenceRank(&state->sequence, state->string);
+    if(k >= length - rank) {
+        state->done = 1;
+        return -1;
+    }
+    state->string = sequenceString(&state->sequence, rank + k);
+    return 0;
+}
+
+/* Writes up to count strings of a sequence into buffer, continuing from where
+ * the state last stopped. Returns the number of strings written, which is
+ * less than count only when the sequence ends.
+ */
+static inline __attribute__((flatten)) unsigned long fillCombinations(unsigned long *buffer, unsigned long count, struct sequenceState *state) {
+    unsigned long string = state->string, written = 0;
+    unsigned int next = 0;
+    long n = state->sequence.length, min = state->sequence.min, max = state->sequence.max;
+    int more = 1;
+
+    if(state->done) {
+        return 0;
+    }
+    switch(state->sequence.kind) {
+    case FIXED_WEIGHT:
+        while(more && written < count) {
+            buffer[written++] = string;
+            more = stepWeightedCombination(n, string, &next) != -1;
+            string = next;
+        }
+        break;
+    case GENERAL:
+        while(more && written < count) {
+            buffer[written++] = string;
+            more = stepGeneralCombination(n, string, &next) != -1;
+            string = next;
+        }
+        break;
+    default:
+        while(more && written < count) {
+            buffer[written++] = string;
+            more = stepRangedCombination(n, string, min, max, &next) != -1;
+            string = next;
+        }
+    }
+    state->string = string;
+    state->done = !more;
+    return written;
+}
+
+/* Waits for an asynchronous memory function to set the done word at the
+ * address it was given, which the caller clears beforehand. Returns what the
+ * function would have returned without ASYNC: the string after the chunk for
+ * functions 12-14, and for functions 4-6 the sum of the data in the cache's
+ * store responses.
+ */
+static inline unsigned long waitCombinations(volatile unsigned long *done) {
+    unsigned long word;
+
+    while(!((word = *done) & LONGTOP));
+    return word & ~LONGTOP;
+}
+
+#endif //__COMBINATIONS_H
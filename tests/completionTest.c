@@ -0,0 +1,61 @@
+// Tests that the memory functions only respond once every store is complete
+// (c) Maddie Burbage, 2020
+
+#include "rocc.h"
+#include "combinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GUARD 0xa5a5a5a5a5a5a5a5 //Fills the buffer before each run
+
+static unsigned long buffer[1 << 14];
+
+/* Has the accelerator store a sequence long enough to keep many stores in
+ * flight, then reads it back straight after the response, last string first,
+ * with no fence between them.
+ */
+static int testCompletion(const struct sequence *s) {
+    unsigned long constraints, count, index, string, response = 0;
+    unsigned int next = 0;
+    int mismatches = 0;
+
+    constraints = s->length | (s->min << 6) | (s->max << 12);
+    count = sequenceLength(s);
+    for(index = 0; index < sizeof(buffer) / sizeof(buffer[0]); index++) {
+        buffer[index] = GUARD;
+    }
+    asm volatile ("fence");
+    switch(s->kind) {
+    case FIXED_WEIGHT: ROCC_INSTRUCTION_DSS(0, response, constraints, &buffer[0], 4); break;
+    case GENERAL: ROCC_INSTRUCTION_DSS(0, response, constraints, &buffer[0], 5); break;
+    default: ROCC_INSTRUCTION_DSS(0, response, constraints, &buffer[0], 6);
+    }
+
+    if(buffer[count - 1] == GUARD) {
+        printf("ERROR: kind %d responded before its last store\n", s->kind);
+        mismatches++;
+    }
+    string = sequenceString(s, 0);
+    for(index = 0; index < count; index++) {
+        if(buffer[index] != string) {
+            mismatches++;
+        }
+        sequenceNext(s, string, &next);
+        string = next;
+    }
+    printf("Accelerator response for kind %d: %lx\n", s->kind, response);
+    return mismatches;
+}
+
+int main(void) {
+    struct sequence sequences[] = {{FIXED_WEIGHT, 16, 7, 7}, {GENERAL, 14, 0, 14}, {RANGED, 14, 5, 8}};
+    unsigned int i;
+    int mismatches = 0;
+
+    for(i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        mismatches += testCompletion(&sequences[i]);
+    }
+    printf("Completion mismatches: %d\n", mismatches);
+    return mismatches;
+}
@@ -0,0 +1,85 @@
+//Benchmark splitting each combination sequence between several harts
+// (c) Maddie Burbage, 2020
+
+#include "rocc.h"
+#include "encoding.h"
+#include "util.h"
+#include "ringCombinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_SLOTS 9 //Each hart's ring holds 2^9 strings
+#define FILL_STRINGS 512 //Strings the software writes per call
+
+static unsigned long cycles[NCORES]; //Cycles each hart took for its slice
+static unsigned long strings[NCORES]; //Strings each hart generated
+
+#if WARE == 1 //Each hart's accelerator streams its slice through the hart's own ring
+static struct {
+    struct combinationRing ring;
+    unsigned long slots[1 << LOG_SLOTS];
+} rings[NCORES] __attribute__((aligned(64)));
+
+static unsigned long generateSlice(int cid, const struct sequence *s, unsigned long start, unsigned long end, unsigned long count) {
+    const unsigned long *slots;
+    unsigned long response, found, read = 0;
+
+    ROCC_INSTRUCTION_DSS(0, response, start, end, RANGE);
+    (void) response;
+    startRing(&rings[cid].ring, s, LOG_SLOTS);
+    while((found = readRing(&rings[cid].ring, LOG_SLOTS, &slots)) != 0) {
+        releaseRing(&rings[cid].ring, found);
+        read += found;
+    }
+    return read;
+}
+#else //Each hart writes its slice with the bulk software, through a buffer of its own
+static unsigned long buffers[NCORES][FILL_STRINGS] __attribute__((aligned(64)));
+
+static unsigned long generateSlice(int cid, const struct sequence *s, unsigned long start, unsigned long end, unsigned long count) {
+    struct sequenceState state;
+    unsigned long written = 0;
+
+    startCombinations(&state, s, sequenceRank(s, start));
+    while(written < count) {
+        written += fillCombinations(buffers[cid], (count - written < FILL_STRINGS)? count - written : FILL_STRINGS, &state);
+    }
+    return written;
+}
+#endif
+
+/* Every hart finds the strings that start and end its slice, waits for the
+ * others, then generates its slice while counting cycles. Hart 0 reports each
+ * hart's cycles and the strings generated per thousand cycles by all of them
+ * together, timed by the slowest hart.
+ */
+void thread_entry(int cid, int nc) {
+    #if FUNCT % 4 == 2
+    struct sequence s = {RANGED, WIDTH, 0, WIDTH/2};
+    #else
+    struct sequence s = {FUNCT % 4, WIDTH, WIDTH/2, WIDTH/2};
+    #endif
+    unsigned long length = sequenceLength(&s), start, end, startCycle, slowest = 0, total = 0;
+    int i;
+
+    sequenceSlice(&s, cid, nc, &start, &end);
+    barrier(nc);
+    asm volatile ("fence");
+    startCycle = rdcycle();
+    strings[cid] = generateSlice(cid, &s, start, end, length * (cid + 1) / nc - length * cid / nc);
+    asm volatile ("fence");
+    cycles[cid] = rdcycle() - startCycle;
+    barrier(nc);
+
+    if(cid == 0) {
+        for(i = 0; i < nc; i++) {
+            printf("hart %d: %lu strings, %lu cycles\n", i, strings[i], cycles[i]);
+            slowest = (cycles[i] > slowest)? cycles[i] : slowest;
+            total += strings[i];
+        }
+        printf("%d, %d, %lu, %lu \n", WIDTH, nc, slowest, total * 1000 / slowest);
+        exit((total == length)? 0 : -1);
+    }
+    while(1);
+}
@@ -0,0 +1,75 @@
+// Tests for the cursor instructions, stepping several sequences at once
+// (c) Maddie Burbage, 2020
+
+#include "rocc.h"
+#include "combinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CURSORS 4
+
+//Opens a cursor at a start string of a sequence
+static unsigned long openCursor(const struct sequence *s, unsigned long cursor, unsigned long start) {
+    unsigned long constraints = s->length | (s->min << 6) | (s->max << 12) | START_STRING(start), first;
+
+    switch(s->kind) {
+    case FIXED_WEIGHT: ROCC_INSTRUCTION_DSS(0, first, constraints, cursor, FIXED_WEIGHT + CURSOR_OPEN); break;
+    case GENERAL: ROCC_INSTRUCTION_DSS(0, first, constraints, cursor, GENERAL + CURSOR_OPEN); break;
+    default: ROCC_INSTRUCTION_DSS(0, first, constraints, cursor, RANGED + CURSOR_OPEN);
+    }
+    return first;
+}
+
+static unsigned long nextCursor(unsigned long cursor) {
+    unsigned long next;
+
+    ROCC_INSTRUCTION_DSS(0, next, 0, cursor, CURSOR_NEXT);
+    return next;
+}
+
+/* Opens a cursor on each sequence, some partway through, then steps them in
+ * turn, so each cursor is checked against the software sequence while the
+ * others are in use. Finished cursors must keep returning -1.
+ */
+int main(void) {
+    struct sequence sequences[CURSORS] = {{FIXED_WEIGHT, 10, 5, 5}, {GENERAL, 9, 0, 9}, {RANGED, 10, 2, 6}, {GENERAL, 6, 0, 6}};
+    unsigned long expected[CURSORS], left[CURSORS], start, string;
+    unsigned int next = 0, i;
+    int active = CURSORS, mismatches = 0;
+
+    for(i = 0; i < CURSORS; i++) {
+        start = (i == CURSORS - 1)? sequenceLength(&sequences[i]) / 2 : 0;
+        expected[i] = sequenceString(&sequences[i], start);
+        left[i] = sequenceLength(&sequences[i]) - start;
+        if(openCursor(&sequences[i], i, expected[i]) != expected[i]) {
+            mismatches++;
+        }
+    }
+    while(active > 0) {
+        for(i = 0; i < CURSORS; i++) {
+            if(left[i] == 0) {
+                continue;
+            }
+            string = nextCursor(i);
+            if(--left[i] == 0) {
+                active--;
+                if(string != 0xffffffff || nextCursor(i) != 0xffffffff) {
+                    printf("ERROR: cursor %u does not end\n", i);
+                    mismatches++;
+                }
+                continue;
+            }
+            sequenceNext(&sequences[i], expected[i], &next);
+            expected[i] = next;
+            if(string != expected[i]) {
+                printf("ERROR: cursor %u returned %lx for %lx\n", i, string, expected[i]);
+                mismatches++;
+                left[i] = 0;
+                active--;
+            }
+        }
+    }
+    printf("Cursor mismatches: %d\n", mismatches);
+    return mismatches;
+}
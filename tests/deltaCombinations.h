@@ -0,0 +1,142 @@
+// Delta-encoded streams of combinations, written by software or the accelerator
+// (c) Maddie Burbage, 2020
+
+#ifndef __DELTA_COMBINATIONS_H
+#define __DELTA_COMBINATIONS_H
+
+#include "combinations.h"
+
+/* Every successor rotates the bits of a string from bit 0 up to some top bit
+ * by one position, so a step is described by that top bit alone. Cool-lex
+ * steps rotate up, moving the top bit to bit 0, and cool-er and cool-est
+ * steps rotate down, moving bit 0 to the top, where it may also be flipped.
+ * A step's code is one byte, holding the top bit and whether it was flipped.
+ *
+ * A stream is cut into 64-byte blocks. Each starts with a keyframe, the full
+ * string as a 64-bit word, followed by the codes of the next 56 strings,
+ * eight to a word, lowest byte first. A block holds 57 strings, so any
+ * string is found from the keyframe of its block and at most 56 codes. The
+ * last block stops after the word holding its last code.
+ */
+#define DELTA_BLOCK_BYTES 64
+#define DELTA_BLOCK_STEPS 56 //Codes after each keyframe
+#define DELTA_BLOCK_STRINGS (DELTA_BLOCK_STEPS + 1)
+#define DELTA_TOP 0x3f //The top bit of a step's rotation
+#define DELTA_FLIP 0x40 //Set when the bit moved to the top is flipped
+
+#define DELTA_FORMAT (1L << 18) //Set in register 1 for functions 4-6 to store a delta stream
+
+//Counts the bytes in a stream of count strings
+static inline unsigned long deltaStreamBytes(unsigned long count) {
+    unsigned long left = count % DELTA_BLOCK_STRINGS;
+    return count / DELTA_BLOCK_STRINGS * DELTA_BLOCK_BYTES + ((left == 0)? 0 : 8 + (left + 6) / 8 * 8);
+}
+
+/* Finds the code for the step from one string to the next in a sequence.
+ * For cool-lex steps the top bit always changes and is the highest bit that
+ * does. For the others it ends the first "01" above bit 0, or is the last
+ * bit of the string without one.
+ */
+static inline unsigned int deltaCode(const struct sequence *s, unsigned long last, unsigned long next) {
+    unsigned long above;
+    long top;
+
+    if(s->kind == FIXED_WEIGHT) {
+        return 63 - __builtin_clzl(last ^ next);
+    }
+    above = last & ~1UL;
+    above = ~last & ~((above & -above) - 1) & ~1UL; //Zeros above the lowest 1 past bit 0
+    top = ((last & ~1UL) == 0 || above == 0)? s->length - 1 : __builtin_ctzl(above);
+    top = (top > s->length - 1)? s->length - 1 : top;
+    return top | ((((next >> top) ^ last) & 1)? DELTA_FLIP : 0);
+}
+
+//Applies a step's code to a string of a sequence of the given kind
+static inline unsigned long applyDelta(int kind, unsigned long string, unsigned int code) {
+    long top = code & DELTA_TOP;
+    unsigned long prefix = (top == 63)? ~0UL : (2UL << top) - 1, moved;
+
+    if(kind == FIXED_WEIGHT) {
+        moved = (string >> top) & 1;
+        return (string & ~prefix) | (((string << 1) | moved) & prefix);
+    }
+    moved = (string & 1) ^ ((code & DELTA_FLIP)? 1 : 0);
+    return (string & ~prefix) | (string & prefix) >> 1 | moved << top;
+}
+
+/* Writes a whole sequence to buffer as a delta stream, which needs
+ * deltaStreamBytes(sequenceLength(s)) bytes and must be 8-byte aligned.
+ * Returns the number of bytes written.
+ */
+static inline unsigned long writeDeltaStream(unsigned char *buffer, const struct sequence *s) {
+    unsigned long string, codes = 0, offset = 8, step = 0;
+    unsigned int next = 0;
+
+    string = sequenceString(s, 0);
+    *(unsigned long *) buffer = string; //The first keyframe
+    while(sequenceNext(s, string, &next) != -1) {
+        step = (step + 1) % DELTA_BLOCK_STRINGS; //Place of the next string in its block
+        if(step == 0) { //Keyframe
+            *(unsigned long *) (buffer + offset) = next;
+            offset += 8;
+        } else {
+            codes |= (unsigned long) deltaCode(s, string, next) << (step - 1) % 8 * 8;
+            if(step % 8 == 0) {
+                *(unsigned long *) (buffer + offset) = codes;
+                offset += 8;
+                codes = 0;
+            }
+        }
+        string = next;
+    }
+    if(step % 8 != 0) { //The last codes fill part of a word
+        *(unsigned long *) (buffer + offset) = codes;
+        offset += 8;
+    }
+    return offset;
+}
+
+//The place of a reader within a delta stream
+struct deltaReader {
+    int kind;
+    const unsigned char *buffer;
+    unsigned long count; //Strings in the stream
+    unsigned long index; //Index of the next string to read
+    unsigned long string; //The string before it, unless index is at a keyframe
+};
+
+/* Sets up a reader at any string of a stream written for a sequence,
+ * starting from the keyframe of the string's block.
+ */
+static inline void seekDeltaStream(struct deltaReader *reader, const unsigned char *buffer, const struct sequence *s, unsigned long index) {
+    unsigned long block = index / DELTA_BLOCK_STRINGS, step;
+    const unsigned char *codes = buffer + block * DELTA_BLOCK_BYTES + 8;
+
+    reader->kind = s->kind;
+    reader->buffer = buffer;
+    reader->count = sequenceLength(s);
+    reader->index = index;
+    reader->string = *(const unsigned long *) (buffer + block * DELTA_BLOCK_BYTES);
+    for(step = 1; step < index % DELTA_BLOCK_STRINGS; step++) {
+        reader->string = applyDelta(s->kind, reader->string, codes[step - 1]);
+    }
+}
+
+/* Decodes up to count strings into out, continuing from where the reader
+ * last stopped. Returns the number of strings decoded, which is less than
+ * count only at the end of the stream.
+ */
+static inline unsigned long readDeltaStream(unsigned long *out, unsigned long count, struct deltaReader *reader) {
+    unsigned long i, step;
+    const unsigned char *block;
+
+    for(i = 0; i < count && reader->index < reader->count; i++, reader->index++) {
+        block = reader->buffer + reader->index / DELTA_BLOCK_STRINGS * DELTA_BLOCK_BYTES;
+        step = reader->index % DELTA_BLOCK_STRINGS;
+        reader->string = (step == 0)? *(const unsigned long *) block : applyDelta(reader->kind, reader->string, block[7 + step]);
+        out[i] = reader->string;
+    }
+    return i;
+}
+
+#endif //__DELTA_COMBINATIONS_H
@@ -0,0 +1,121 @@
+// Tests for the delta-encoded combination streams
+// (c) Maddie Burbage, 2020
+
+#include "rocc.h"
+#include "deltaCombinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LENGTH 12 //The longest strings streamed, for 4096 strings at most
+#define CHUNK 5 //Strings decoded at a time
+
+static unsigned long buffer[(1 << MAX_LENGTH) / DELTA_BLOCK_STRINGS * 8 + 16];
+static unsigned long accelerated[(1 << MAX_LENGTH) / DELTA_BLOCK_STRINGS * 8 + 16];
+
+/* Writes a sequence as a delta stream, then decodes it in chunks and from
+ * every keyframe and some strings between them, comparing with the successor.
+ */
+static int testStream(const struct sequence *s) {
+    struct deltaReader reader;
+    unsigned long count, bytes, index, i, decoded[CHUNK], expected;
+    unsigned int next;
+    int mismatches = 0;
+
+    count = sequenceLength(s);
+    bytes = writeDeltaStream((unsigned char *) buffer, s);
+    if(bytes != deltaStreamBytes(count)) {
+        printf("ERROR: kind %d length %ld wrote %lu bytes\n", s->kind, s->length, bytes);
+        mismatches++;
+    }
+
+    seekDeltaStream(&reader, (unsigned char *) buffer, s, 0);
+    expected = sequenceString(s, 0);
+    index = 0;
+    while((bytes = readDeltaStream(decoded, CHUNK, &reader)) > 0) {
+        for(i = 0; i < bytes; i++, index++) {
+            if(decoded[i] != expected) {
+                mismatches++;
+            }
+            if(sequenceNext(s, expected, &next) != -1) {
+                expected = next;
+            }
+        }
+    }
+    if(index != count) {
+        mismatches++;
+    }
+
+    for(index = 0; index < count; index += 19) {
+        seekDeltaStream(&reader, (unsigned char *) buffer, s, index);
+        if(readDeltaStream(decoded, 1, &reader) != 1 || decoded[0] != sequenceString(s, index)) {
+            printf("ERROR: kind %d length %ld seeking to %lu\n", s->kind, s->length, index);
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+/* Has the accelerator store a sequence as a delta stream, which should match
+ * the software's stream word for word.
+ */
+static int testAccelerator(const struct sequence *s) {
+    unsigned long constraints, words, i, stores = 0;
+    int mismatches = 0;
+
+    constraints = s->length | (s->min << 6) | (s->max << 12) | DELTA_FORMAT;
+    words = writeDeltaStream((unsigned char *) buffer, s) / 8;
+    memset(accelerated, 0, sizeof(accelerated));
+    asm volatile ("fence");
+    switch(s->kind) {
+    case FIXED_WEIGHT: ROCC_INSTRUCTION_DSS(0, stores, constraints, &accelerated[0], 4); break;
+    case GENERAL: ROCC_INSTRUCTION_DSS(0, stores, constraints, &accelerated[0], 5); break;
+    default: ROCC_INSTRUCTION_DSS(0, stores, constraints, &accelerated[0], 6);
+    }
+    asm volatile ("fence");
+    printf("Accelerator response for kind %d: %lx\n", s->kind, stores);
+    for(i = 0; i < words; i++) {
+        if(accelerated[i] != buffer[i]) {
+            printf("ERROR: kind %d length %ld word %lu: accelerator %lx, software %lx\n", s->kind, s->length, i, accelerated[i], buffer[i]);
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+int main(void) {
+    struct sequence s;
+    long n;
+    int mismatches = 0;
+
+    for(n = 1; n <= MAX_LENGTH; n++) {
+        s.length = n;
+        s.kind = FIXED_WEIGHT;
+        s.min = s.max = (n + 1)/2;
+        mismatches += testStream(&s);
+        s.kind = GENERAL;
+        s.min = 0;
+        s.max = n;
+        mismatches += testStream(&s);
+        s.kind = RANGED;
+        s.min = n/4;
+        s.max = n/2 + 1;
+        mismatches += testStream(&s);
+    }
+    printf("Delta stream mismatches: %d\n", mismatches);
+
+    s.length = 10;
+    s.kind = FIXED_WEIGHT;
+    s.min = s.max = 5;
+    mismatches += testAccelerator(&s);
+    s.kind = GENERAL;
+    s.min = 0;
+    s.max = 10;
+    mismatches += testAccelerator(&s);
+    s.kind = RANGED;
+    s.min = 2;
+    s.max = 6;
+    mismatches += testAccelerator(&s);
+    printf("Total delta mismatches: %d\n", mismatches);
+    return mismatches;
+}
@@ -9,9 +9,11 @@ while [ $FUNCT -lt 3 ]; do
     while [ $WIDTHI -lt $MAX ]; do
 	WIDTH=${WIDTHS[$WIDTHI]}
 	export WARE=0
-	while [ $WARE -lt 2 ]; do
-            make timeTests.riscv
-            mv timeTests.riscv timeTests-$FUNCT-$WARE-$WIDTH.riscv
+	while [ $WARE -lt 5 ]; do
+            if [ $WARE -lt 4 ] || [ $WIDTH -le 16 ]; then #Tables only hold strings up to 16 bits
+                make timeTests.riscv
+                mv timeTests.riscv timeTests-$FUNCT-$WARE-$WIDTH.riscv
+            fi
             let WARE=$WARE+1
         done
         let WIDTHI=$WIDTHI+1
@@ -19,6 +21,20 @@ while [ $FUNCT -lt 3 ]; do
     let FUNCT=$FUNCT+1
 done
 
+#Hardware stepping through cursors, which keep the last string
+FUNCT=64
+WARE=1
+while [ $FUNCT -lt 67 ]; do
+    WIDTHI=0
+    while [ $WIDTHI -lt $MAX ]; do
+        WIDTH=${WIDTHS[$WIDTHI]}
+        make timeTests.riscv
+        mv timeTests.riscv timeTests-$FUNCT-$WARE-$WIDTH.riscv
+        let WIDTHI=$WIDTHI+1
+    done
+    let FUNCT=$FUNCT+1
+done
+
 MAX=4
 
 FUNCT=4
@@ -28,9 +44,25 @@ while [ $FUNCT -lt 7 ]; do
     while [ $WIDTHI -lt $MAX ]; do
         WIDTH=${WIDTHS[$WIDTHI]}
 	WARE=0
-	while [ $WARE -lt 2 ]; do
-            make timeTests.riscv
-            mv timeTests.riscv timeTests-$FUNCT-$WARE-$WIDTH.riscv
+	while [ $WARE -lt 5 ]; do
+            if [ $WARE -lt 4 ] || [ $WIDTH -le 16 ]; then #Tables only hold strings up to 16 bits
+                make timeTests.riscv
+                mv timeTests.riscv timeTests-$FUNCT-$WARE-$WIDTH.riscv
+            fi
+            if [ $WARE -lt 2 ]; then #Delta-encoded and bit-packed stores from the first software and the hardware
+                FORMAT=1 make timeTests.riscv
+                mv timeTests.riscv timeTests-$FUNCT-$WARE-$WIDTH-delta.riscv
+                FORMAT=2 make timeTests.riscv
+                mv timeTests.riscv timeTests-$FUNCT-$WARE-$WIDTH-packed.riscv
+            fi
+            if [ $WARE -eq 1 ]; then #Hardware storing the fewest bytes that hold each string
+                BYTES=1
+                while [ $((BYTES * 8)) -lt $WIDTH ]; do
+                    let BYTES=$BYTES*2
+                done
+                BYTES=$BYTES make timeTests.riscv
+                mv timeTests.riscv timeTests-$FUNCT-$WARE-$WIDTH-${BYTES}byte.riscv
+            fi
             let WARE=$WARE+1
         done
         let WIDTHI=$WIDTHI+1
@@ -38,4 +70,50 @@ while [ $FUNCT -lt 7 ]; do
     let FUNCT=$FUNCT+1
 done
 
+#Bounded stores from the hardware, in fixed-size chunks up to the widest strings
+MAX=8
+FUNCT=12
+WARE=1
+while [ $FUNCT -lt 15 ]; do
+    WIDTHI=0
+    while [ $WIDTHI -lt $MAX ]; do
+        WIDTH=${WIDTHS[$WIDTHI]}
+        make timeTests.riscv
+        mv timeTests.riscv timeTests-$FUNCT-$WARE-$WIDTH.riscv
+        let WIDTHI=$WIDTHI+1
+    done
+    let FUNCT=$FUNCT+1
+done
+
+#Hardware streaming through a ring, up to the widest strings
+FUNCT=36
+while [ $FUNCT -lt 39 ]; do
+    WIDTHI=0
+    while [ $WIDTHI -lt $MAX ]; do
+        WIDTH=${WIDTHS[$WIDTHI]}
+        make timeTests.riscv
+        mv timeTests.riscv timeTests-$FUNCT-$WARE-$WIDTH.riscv
+        let WIDTHI=$WIDTHI+1
+    done
+    let FUNCT=$FUNCT+1
+done
+
 echo Made tests for functions up to $FUNCT-1 and widths up to $WIDTH
+
+#Each sequence split between several harts, in software and with each hart's accelerator
+for NCORES in 1 2 4 8; do
+    export NCORES
+    rm -f crt.o #The start-up code starts NCORES harts
+    for FUNCT in 0 1 2; do
+        for WARE in 0 1; do
+            for WIDTH in 16 20; do
+                rm -f coreTests.o
+                make coreTests.riscv
+                mv coreTests.riscv coreTests-$FUNCT-$WARE-$WIDTH-${NCORES}core.riscv
+            done
+        done
+    done
+done
+rm -f crt.o coreTests.o
+
+echo Made multi-core tests for up to $NCORES harts
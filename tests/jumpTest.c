@@ -0,0 +1,80 @@
+// Tests for jumping ahead in a sequence, in software and with the accelerator
+// (c) Maddie Burbage, 2020
+
+#include "rocc.h"
+#include "combinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLES 12 //Ranks jumped from in each sequence
+
+//Has the accelerator jump k places from a string, returning -1 past the end
+static unsigned long jumpAccelerator(const struct sequence *s, unsigned long string, unsigned long k) {
+    unsigned long constraints = s->length | (s->min << 6) | (s->max << 12) | START_STRING(string), out;
+
+    switch(s->kind) {
+    case FIXED_WEIGHT: ROCC_INSTRUCTION_DSS(0, out, constraints, k, FIXED_WEIGHT + JUMP_AHEAD); break;
+    case GENERAL: ROCC_INSTRUCTION_DSS(0, out, constraints, k, GENERAL + JUMP_AHEAD); break;
+    default: ROCC_INSTRUCTION_DSS(0, out, constraints, k, RANGED + JUMP_AHEAD);
+    }
+    return out;
+}
+
+/* Jumps from sampled ranks of a sequence by several distances, including
+ * to its last string and past its end, checking the software against
+ * stepping through the sequence and the accelerator against the software.
+ */
+static int testJumps(const struct sequence *s) {
+    struct sequenceState state;
+    unsigned long length = sequenceLength(s), rank, string, expected, k, ks[6];
+    unsigned int next = 0;
+    int i, j, more, mismatches = 0;
+
+    for(i = 0; i < SAMPLES; i++) {
+        rank = length / SAMPLES * i;
+        string = sequenceString(s, rank);
+        ks[0] = 0;
+        ks[1] = 1;
+        ks[2] = 5;
+        ks[3] = (length - rank) / 2;
+        ks[4] = length - rank - 1;
+        ks[5] = length - rank;
+        for(j = 0; j < 6; j++) {
+            k = ks[j];
+            startCombinations(&state, s, rank);
+            more = advanceCombinations(&state, k);
+            if(k < 8) { //Step the short jumps
+                expected = string;
+                for(; k > 0 && sequenceNext(s, expected, &next) != -1; k--) {
+                    expected = next;
+                }
+                if((k == 0) != (more == 0) || (more == 0 && state.string != expected)) {
+                    printf("ERROR: kind %d length %ld advancing %lu from %lu\n", s->kind, s->length, ks[j], rank);
+                    mismatches++;
+                }
+            } else if((ks[j] < length - rank) != (more == 0)) {
+                mismatches++;
+            }
+            expected = (more == 0)? state.string : 0xffffffff;
+            if(jumpAccelerator(s, string, ks[j]) != expected) {
+                printf("ERROR: kind %d length %ld jumping %lu from %lu\n", s->kind, s->length, ks[j], rank);
+                mismatches++;
+            }
+        }
+    }
+    return mismatches;
+}
+
+int main(void) {
+    struct sequence sequences[] = {{FIXED_WEIGHT, 8, 3, 3}, {FIXED_WEIGHT, 32, 16, 16}, {GENERAL, 12, 0, 12}, {GENERAL, 31, 0, 31},
+        {RANGED, 10, 0, 4}, {RANGED, 20, 5, 12}, {RANGED, 32, 8, 24}};
+    unsigned int i;
+    int mismatches = 0;
+
+    for(i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        mismatches += testJumps(&sequences[i]);
+    }
+    printf("Jump mismatches: %d\n", mismatches);
+    return mismatches;
+}
@@ -0,0 +1,247 @@
+// Software combination sequences for strings of any length, held in several words
+// (c) Maddie Burbage, 2020
+
+#ifndef __MULTIWORD_COMBINATIONS_H
+#define __MULTIWORD_COMBINATIONS_H
+
+#include "combinations.h"
+
+#define WORD_BITS 64
+#define MULTIWORD_WORDS(n) (((n) + WORD_BITS - 1) / WORD_BITS) //Words needed for a string of length n
+
+/* A string of length n is held in MULTIWORD_WORDS(n) words, lowest bits in the
+ * first word, with the bits past the end of the string kept clear. Every
+ * successor rotates a prefix of the string starting at bit 0 by one position,
+ * so each step only reads and writes the words up to the end of that prefix.
+ * The weight of the string is kept alongside it, so the cool-est successor
+ * never has to count the ones in the whole string.
+ */
+struct multiwordState {
+    struct sequence sequence;
+    unsigned long *string; //The next string to hand over
+    long weight; //The ones in string
+    long touched; //The words of string changed since the last one handed over
+    int done;
+};
+
+/* Called once per string by streamMultiwordCombinations, with the number of
+ * low words that changed since the previous string. Returns 0 to keep going.
+ */
+typedef int (*multiwordConsumer)(void *context, const unsigned long *string, long touched);
+
+static inline int multiwordBit(const unsigned long *string, long i) {
+    return (string[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+}
+
+//The mask of the bits of a word at or below an index into the word
+static inline unsigned long wordBitsTo(long i) {
+    return (i >= WORD_BITS - 1)? ~0UL : (2UL << i) - 1;
+}
+
+/* Rotates bits 0 to top of a string up by one, moving bit top to bit 0.
+ * Works down from the highest word, so each word still holds its old bits
+ * when the word above takes its carry.
+ */
+static inline void rotateMultiwordUp(unsigned long *string, long top) {
+    long w, last = top / WORD_BITS;
+    unsigned long moved, shifted, keep;
+
+    moved = multiwordBit(string, top);
+    keep = ~wordBitsTo(top % WORD_BITS);
+    for(w = last; w >= 0; w--) {
+        shifted = (string[w] << 1) | ((w > 0)? string[w-1] >> (WORD_BITS - 1) : moved);
+        string[w] = (w == last)? (shifted & ~keep) | (string[w] & keep) : shifted;
+    }
+}
+
+/* Rotates bits 0 to top of a string down by one, putting the given bit at
+ * top. Works up from the lowest word for the same reason.
+ */
+static inline void rotateMultiwordDown(unsigned long *string, long top, unsigned long moved) {
+    long w, last = top / WORD_BITS;
+    unsigned long shifted, keep;
+
+    keep = ~wordBitsTo(top % WORD_BITS);
+    for(w = 0; w < last; w++) {
+        string[w] = (string[w] >> 1) | (string[w+1] << (WORD_BITS - 1));
+    }
+    shifted = ((string[last] & ~keep) >> 1) | (moved << (top % WORD_BITS));
+    string[last] = shifted | (string[last] & keep);
+}
+
+//Finds the lowest bit at or above start that matches the given bit, or -1
+static inline long findMultiwordBit(const unsigned long *string, long words, long start, int bit) {
+    long w = start / WORD_BITS;
+    unsigned long word;
+
+    if(w >= words) {
+        return -1;
+    }
+    word = (bit? string[w] : ~string[w]) & ~((1UL << (start % WORD_BITS)) - 1);
+    while(word == 0) {
+        if(++w == words) {
+            return -1;
+        }
+        word = bit? string[w] : ~string[w];
+    }
+    return w * WORD_BITS + __builtin_ctzl(word);
+}
+
+/* Steps a fixed-weight string of length n along the cool-lex pattern of
+ * nextWeightedCombination. With t trailing ones and the next 1 at p, the
+ * prefix up to p+1 rotates up when bit p+1 is 0 and the prefix up to p rotates
+ * up otherwise. When the prefix would pass the end of the string the whole
+ * string rotates instead, which brings it back to the first string.
+ * Returns the number of words changed, or -1 when the pattern ends.
+ */
+static inline long nextMultiwordWeighted(long n, unsigned long *string) {
+    long words = MULTIWORD_WORDS(n), trailing, p, top;
+
+    trailing = findMultiwordBit(string, words, 0, 0);
+    trailing = (trailing == -1 || trailing > n)? n : trailing;
+    p = findMultiwordBit(string, words, trailing, 1);
+    if(p == -1) { //Only trailing ones, as in the first string
+        top = trailing;
+        if(trailing == 0) { //No ones to move
+            return -1;
+        }
+    } else {
+        top = (p + 1 < n && multiwordBit(string, p + 1))? p : p + 1;
+    }
+
+    if(top >= n) {
+        rotateMultiwordUp(string, n - 1);
+        return -1;
+    }
+    rotateMultiwordUp(string, top);
+    return top / WORD_BITS + 1;
+}
+
+/* Steps a string of length n along the cool-er pattern of
+ * nextGeneralCombination. Past the first "01" above bit 0, the prefix up to
+ * the 0 rotates down. Without one, the whole string rotates down and the bit
+ * moved from bit 0 to the top is flipped. Returns the number of words
+ * changed, or -1 when the pattern ends back at all ones.
+ */
+static inline long nextMultiwordGeneral(long n, unsigned long *string, long *weight) {
+    long words = MULTIWORD_WORDS(n), one, zero;
+    unsigned long first = string[0] & 1;
+
+    one = findMultiwordBit(string, words, 1, 1);
+    zero = (one == -1)? -1 : findMultiwordBit(string, words, one, 0);
+    if(zero != -1 && zero < n) {
+        rotateMultiwordDown(string, zero, first);
+        return zero / WORD_BITS + 1;
+    }
+
+    rotateMultiwordDown(string, n - 1, first ^ 1);
+    *weight += (first == 1)? -1 : 1;
+    return (*weight == n)? -1 : words;
+}
+
+/* Steps a string of length n along the cool-est pattern of
+ * nextRangedCombination, which follows the cool-er pattern except that the
+ * top bit is only flipped while the weight stays within min and max. Returns
+ * the number of words changed, or -1 when the pattern ends back at the
+ * lowest min bits set.
+ */
+static inline long nextMultiwordRanged(long n, unsigned long *string, long *weight, long min, long max) {
+    long words = MULTIWORD_WORDS(n), one, zero, touched;
+    unsigned long first = string[0] & 1;
+    int valid;
+
+    one = findMultiwordBit(string, words, 1, 1);
+    zero = (one == -1)? -1 : findMultiwordBit(string, words, one, 0);
+    if(zero != -1 && zero < n) {
+        rotateMultiwordDown(string, zero, first);
+        touched = zero / WORD_BITS + 1;
+    } else {
+        valid = (first == 1)? *weight > min : *weight < max;
+        rotateMultiwordDown(string, n - 1, valid? first ^ 1 : first);
+        *weight += (!valid)? 0 : (first == 1)? -1 : 1;
+        touched = words;
+    }
+
+    //The first string is the only one of weight min with its lowest zero at min.
+    //A rotated prefix always leaves a zero inside itself, so this stays in range.
+    if(*weight == min) {
+        zero = findMultiwordBit(string, words, 0, 0);
+        if(zero == -1 || zero >= min) {
+            return -1;
+        }
+    }
+    return touched;
+}
+
+/* Sets string to the lowest count bits set, clearing the rest of a length n.
+ */
+static inline void lowMultiwordBits(unsigned long *string, long n, long count) {
+    long w;
+
+    for(w = 0; w < MULTIWORD_WORDS(n); w++) {
+        string[w] = (count >= (w + 1) * WORD_BITS)? ~0UL : (count > w * WORD_BITS)? (1UL << (count % WORD_BITS)) - 1 : 0;
+    }
+}
+
+/* Sets up a state to generate a sequence of any length from its first
+ * string, kept in the given MULTIWORD_WORDS(length) words.
+ */
+static inline void startMultiwordCombinations(struct multiwordState *state, const struct sequence *s, unsigned long *words) {
+    state->sequence = *s;
+    state->string = words;
+    state->weight = (s->kind == GENERAL)? s->length : s->min;
+    state->touched = MULTIWORD_WORDS(s->length);
+    state->done = 0;
+    lowMultiwordBits(words, s->length, state->weight);
+}
+
+/* Moves a state to any string of its sequence, such as one saved from an
+ * earlier run.
+ */
+static inline void seekMultiwordCombination(struct multiwordState *state, const unsigned long *string) {
+    long w;
+
+    state->weight = 0;
+    for(w = 0; w < MULTIWORD_WORDS(state->sequence.length); w++) {
+        state->string[w] = string[w];
+        state->weight += __builtin_popcountl(string[w]);
+    }
+    state->touched = MULTIWORD_WORDS(state->sequence.length);
+    state->done = 0;
+}
+
+/* Steps a state's string to its successor in place. Returns the number of
+ * low words changed, or -1 when the sequence ends, which leaves the string
+ * back at the first one.
+ */
+static inline long nextMultiwordCombination(struct multiwordState *state) {
+    const struct sequence *s = &state->sequence;
+
+    switch(s->kind) {
+    case FIXED_WEIGHT: return nextMultiwordWeighted(s->length, state->string);
+    case GENERAL: return nextMultiwordGeneral(s->length, state->string, &state->weight);
+    default: return nextMultiwordRanged(s->length, state->string, &state->weight, s->min, s->max);
+    }
+}
+
+/* Hands each string of a sequence to a consumer, from the state's string on,
+ * until the sequence ends or the consumer returns nonzero. The state then
+ * holds the string after the last one handed over, so streaming can carry on
+ * from there. Returns the number of strings handed over.
+ */
+static inline unsigned long streamMultiwordCombinations(struct multiwordState *state, multiwordConsumer consume, void *context) {
+    unsigned long streamed = 0;
+    int stop = 0;
+
+    while(!state->done && !stop) {
+        stop = consume(context, state->string, state->touched);
+        streamed++;
+        state->touched = nextMultiwordCombination(state);
+        if(state->touched == -1) {
+            state->done = 1;
+        }
+    }
+    return streamed;
+}
+
+#endif //__MULTIWORD_COMBINATIONS_H
@@ -0,0 +1,237 @@
+// Tests for the multiword software combination sequences
+// (c) Maddie Burbage, 2020
+
+#include "multiwordCombinations.h"
+#include "wideCombinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_WORDS 8 //Room for strings up to 512 bits
+#define STEPS 2000 //Steps walked from each sampled string
+#define SAMPLES 16 //Strings sampled from each sequence up to 128 bits
+
+static uint128 toWide(const unsigned long *string, long n) {
+    return (n > WORD_BITS)? ((uint128) string[1] << WORD_BITS) | string[0] : string[0];
+}
+
+static void fromWide(unsigned long *string, uint128 wide) {
+    memset(string, 0, MAX_WORDS * sizeof(unsigned long));
+    string[0] = (unsigned long) wide;
+    string[1] = (unsigned long) (wide >> WORD_BITS);
+}
+
+static int wideStep(const struct sequence *s, uint128 last, uint128 *out) {
+    switch(s->kind) {
+    case FIXED_WEIGHT: return nextWeightedCombination128(s->length, last, out);
+    case GENERAL: return nextGeneralCombination128(s->length, last, out);
+    default: return nextRangedCombination128(s->length, last, s->min, s->max, out);
+    }
+}
+
+static uint128 wideUnrank(const struct sequence *s, uint128 rank) {
+    switch(s->kind) {
+    case FIXED_WEIGHT: return unrankWeightedCombination128(s->length, s->min, rank);
+    case GENERAL: return unrankGeneralCombination128(s->length, rank);
+    default: return unrankRangedCombination128(s->length, rank, s->min, s->max);
+    }
+}
+
+static uint128 wideLength(const struct sequence *s) {
+    switch(s->kind) {
+    case FIXED_WEIGHT: return binomial128(s->length, s->min);
+    case GENERAL: return lowBits128(s->length) + 1;
+    default: return countRangedCombinations128(s->length, s->min, s->max);
+    }
+}
+
+/* Steps a multiword state, checking that only the words it reports changed,
+ * that the string stays within its length and that the weight is kept.
+ */
+static long checkedStep(struct multiwordState *state, int *mismatches) {
+    unsigned long before[MAX_WORDS];
+    long touched, w, words = MULTIWORD_WORDS(state->sequence.length), weight = 0;
+
+    memcpy(before, state->string, sizeof(before));
+    touched = nextMultiwordCombination(state);
+    for(w = 0; w < words; w++) {
+        if(touched != -1 && w >= touched && state->string[w] != before[w]) {
+            (*mismatches)++;
+        }
+        weight += __builtin_popcountl(state->string[w]);
+    }
+    if(state->string[words - 1] & ~wordBitsTo((state->sequence.length - 1) % WORD_BITS)) {
+        (*mismatches)++;
+    }
+    if(weight != state->weight && state->sequence.kind != FIXED_WEIGHT) {
+        (*mismatches)++;
+    }
+    return touched;
+}
+
+/* Walks a sequence up to 128 bits long from sampled ranks, comparing the
+ * multiword successor with the 128-bit one. Short sequences are walked in full
+ * to check that they end back at the first string.
+ */
+static int testAgainstWide(const struct sequence *s) {
+    unsigned long words[MAX_WORDS] = {0}, first[MAX_WORDS];
+    struct multiwordState state;
+    uint128 count, rank, expected;
+    long steps, touched;
+    int i, more, mismatches = 0;
+
+    startMultiwordCombinations(&state, s, words);
+    memcpy(first, words, sizeof(first));
+    if(toWide(words, s->length) != wideUnrank(s, 0)) {
+        mismatches++;
+    }
+    count = wideLength(s);
+    for(i = 0; i < SAMPLES; i++) {
+        rank = (count == 0)? (uint128) i << 120 : count / SAMPLES * i;
+        fromWide(first, wideUnrank(s, rank));
+        seekMultiwordCombination(&state, first);
+        for(steps = 0; steps < STEPS; steps++) {
+            expected = toWide(state.string, s->length);
+            more = wideStep(s, expected, &expected);
+            touched = checkedStep(&state, &mismatches);
+            if(more == -1) {
+                if(touched != -1 || toWide(state.string, s->length) != wideUnrank(s, 0)) {
+                    printf("ERROR: kind %d length %ld does not end\n", s->kind, s->length);
+                    mismatches++;
+                }
+                break;
+            }
+            if(touched == -1 || toWide(state.string, s->length) != expected) {
+                printf("ERROR: kind %d length %ld step %ld from sample %d\n", s->kind, s->length, steps, i);
+                mismatches++;
+                break;
+            }
+        }
+    }
+    return mismatches;
+}
+
+//Counts the strings streamed and the words they changed
+struct tally {
+    unsigned long strings;
+    unsigned long touched;
+    unsigned long limit;
+};
+
+static int countString(void *context, const unsigned long *string, long touched) {
+    struct tally *t = context;
+
+    t->strings++;
+    t->touched += touched;
+    return t->strings == t->limit;
+}
+
+/* Streams the start of a sequence longer than 128 bits in two parts, checking
+ * that a fixed-weight sequence begins like the 128-bit one, since cool-lex
+ * strings of length n begin with those of length n-1 with a 0 appended, and
+ * that the steps change few words on average.
+ */
+static int testStream(const struct sequence *s) {
+    unsigned long words[MAX_WORDS] = {0};
+    struct multiwordState state, check;
+    struct tally t = {0, 0, STEPS};
+    uint128 expected;
+    long steps;
+    int mismatches = 0;
+
+    startMultiwordCombinations(&check, s, words);
+    expected = lowBits128(s->min);
+    for(steps = 0; steps < 4 * STEPS; steps++) {
+        if(s->kind == FIXED_WEIGHT && (toWide(words, WIDE_WIDTH) != expected || words[2] != 0)) {
+            mismatches++;
+        }
+        if(checkedStep(&check, &mismatches) == -1) {
+            mismatches++;
+        }
+        nextWeightedCombination128(WIDE_WIDTH, expected, &expected);
+    }
+
+    startMultiwordCombinations(&state, s, words);
+    if(streamMultiwordCombinations(&state, countString, &t) != STEPS) {
+        mismatches++;
+    }
+    t.limit = 4 * STEPS;
+    if(streamMultiwordCombinations(&state, countString, &t) != 3 * STEPS || state.done) {
+        mismatches++;
+    }
+    //The cool-er sequence begins with its heaviest strings, which rotate whole
+    if(s->kind != GENERAL && t.touched > 2 * t.strings + MULTIWORD_WORDS(s->length)) {
+        printf("ERROR: kind %d length %ld touched %lu words in %lu strings\n", s->kind, s->length, t.touched, t.strings);
+        mismatches++;
+    }
+    return mismatches;
+}
+
+/* Streams a whole short sequence and checks its length.
+ */
+static int testWhole(const struct sequence *s) {
+    unsigned long words[MAX_WORDS];
+    struct multiwordState state;
+    struct tally t = {0, 0, 0};
+
+    startMultiwordCombinations(&state, s, words);
+    if(streamMultiwordCombinations(&state, countString, &t) != wideLength(s) || !state.done) {
+        printf("ERROR: kind %d length %ld streamed %lu strings\n", s->kind, s->length, t.strings);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void) {
+    long widths[] = {1, 2, 5, 12, 16, 63, 64, 65, 100, 127, 128};
+    long longWidths[] = {129, 200, 256, 300, 511, 512};
+    struct sequence s;
+    unsigned int i;
+    long n;
+    int mismatches = 0;
+
+    for(i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+        s.length = n = widths[i];
+        s.kind = FIXED_WEIGHT;
+        s.min = s.max = (n + 1)/2;
+        mismatches += testAgainstWide(&s);
+        s.min = s.max = n;
+        mismatches += testAgainstWide(&s);
+        s.kind = GENERAL;
+        s.min = 0;
+        s.max = n;
+        mismatches += testAgainstWide(&s);
+        s.kind = RANGED;
+        s.min = n/3;
+        s.max = 2*n/3 + 1;
+        mismatches += testAgainstWide(&s);
+        s.min = 0;
+        mismatches += testAgainstWide(&s);
+        if(n <= 16) {
+            mismatches += testWhole(&s);
+            s.kind = GENERAL;
+            mismatches += testWhole(&s);
+            s.kind = FIXED_WEIGHT;
+            s.min = s.max = n/2;
+            mismatches += testWhole(&s);
+        }
+    }
+    printf("Multiword mismatches up to 128 bits: %d\n", mismatches);
+
+    for(i = 0; i < sizeof(longWidths) / sizeof(longWidths[0]); i++) {
+        s.length = n = longWidths[i];
+        s.kind = FIXED_WEIGHT;
+        s.min = s.max = n/8; //Light enough to begin with the 128-bit sequence
+        mismatches += testStream(&s);
+        s.kind = GENERAL;
+        s.min = 0;
+        s.max = n;
+        mismatches += testStream(&s);
+        s.kind = RANGED;
+        s.min = n/3;
+        s.max = 2*n/3;
+        mismatches += testStream(&s);
+    }
+    printf("Total multiword mismatches: %d\n", mismatches);
+    return mismatches;
+}
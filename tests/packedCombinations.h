@@ -0,0 +1,71 @@
+// Bit-packed streams of combinations, written by software or the accelerator
+// (c) Maddie Burbage, 2020
+
+#ifndef __PACKED_COMBINATIONS_H
+#define __PACKED_COMBINATIONS_H
+
+#include "combinations.h"
+
+/* A packed stream stores the strings of a sequence back to back, each taking
+ * exactly the length of the string in bits. The strings fill 64-bit words
+ * from the lowest bit up, so string i starts at bit i * n of the stream and
+ * may run over into the next word. The last word is padded with zeros.
+ */
+#define PACKED_FORMAT (2L << 18) //Set in register 1 for functions 4-6 to store a packed stream
+
+//Counts the bytes in a packed stream of count strings of length n
+static inline unsigned long packedStreamBytes(unsigned long count, long n) {
+    return (count * n + 63) / 64 * 8;
+}
+
+//Finds the string at an index of a packed stream of strings of length n
+static inline unsigned long unpackString(const unsigned long *buffer, long n, unsigned long index) {
+    unsigned long bit = index * n, offset = bit % 64, string;
+
+    string = buffer[bit / 64] >> offset;
+    if(offset + n > 64) { //The string runs over into the next word
+        string |= buffer[bit / 64 + 1] << (64 - offset);
+    }
+    return string & ((1UL << n) - 1);
+}
+
+/* Writes a whole sequence to buffer as a packed stream, which needs
+ * packedStreamBytes(sequenceLength(s), s->length) bytes. Returns the number
+ * of bytes written.
+ */
+static inline unsigned long writePackedStream(unsigned long *buffer, const struct sequence *s) {
+    unsigned long string, word = 0, words = 0;
+    long fill = 0, n = s->length;
+    unsigned int next = 0;
+    int more;
+
+    string = sequenceString(s, 0);
+    do {
+        word |= string << fill;
+        fill += n;
+        if(fill >= 64) { //The word is full, and the rest of the string starts the next one
+            buffer[words++] = word;
+            fill -= 64;
+            word = (fill == 0)? 0 : string >> (n - fill);
+        }
+        more = sequenceNext(s, string, &next);
+        string = next;
+    } while(more != -1);
+    if(fill != 0) {
+        buffer[words++] = word;
+    }
+    return words * 8;
+}
+
+/* Unpacks count strings of length n from a packed stream into out, starting
+ * from the string at index first.
+ */
+static inline void unpackStream(unsigned long *out, const unsigned long *buffer, long n, unsigned long first, unsigned long count) {
+    unsigned long i;
+
+    for(i = 0; i < count; i++) {
+        out[i] = unpackString(buffer, n, first + i);
+    }
+}
+
+#endif //__PACKED_COMBINATIONS_H
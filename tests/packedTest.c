@@ -0,0 +1,111 @@
+// Tests for the bit-packed combination streams
+// (c) Maddie Burbage, 2020
+
+#include "rocc.h"
+#include "packedCombinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LENGTH 12 //The longest strings packed, for 4096 strings at most
+
+static unsigned long buffer[(1 << MAX_LENGTH) * MAX_LENGTH / 64 + 1];
+static unsigned long accelerated[(1 << MAX_LENGTH) * MAX_LENGTH / 64 + 1];
+
+/* Packs a sequence, then checks every string unpacked from it against the
+ * successor, both one at a time and in runs from a few starting points.
+ */
+static int testStream(const struct sequence *s) {
+    unsigned long count, bytes, index, string, run[17];
+    unsigned int next = 0;
+    int mismatches = 0;
+
+    count = sequenceLength(s);
+    bytes = writePackedStream(buffer, s);
+    if(bytes != packedStreamBytes(count, s->length)) {
+        printf("ERROR: kind %d length %ld wrote %lu bytes\n", s->kind, s->length, bytes);
+        mismatches++;
+    }
+
+    string = sequenceString(s, 0);
+    for(index = 0; index < count; index++) {
+        if(unpackString(buffer, s->length, index) != string) {
+            mismatches++;
+        }
+        sequenceNext(s, string, &next);
+        string = next;
+    }
+
+    for(index = 0; index + 17 <= count; index += 23) {
+        unpackStream(run, buffer, s->length, index, 17);
+        if(run[0] != sequenceString(s, index) || run[16] != sequenceString(s, index + 16)) {
+            printf("ERROR: kind %d length %ld unpacking from %lu\n", s->kind, s->length, index);
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+/* Has the accelerator store a sequence as a packed stream, which should match
+ * the software's stream word for word.
+ */
+static int testAccelerator(const struct sequence *s) {
+    unsigned long constraints, words, i, stores = 0;
+    int mismatches = 0;
+
+    constraints = s->length | (s->min << 6) | (s->max << 12) | PACKED_FORMAT;
+    words = writePackedStream(buffer, s) / 8;
+    memset(accelerated, 0, sizeof(accelerated));
+    asm volatile ("fence");
+    switch(s->kind) {
+    case FIXED_WEIGHT: ROCC_INSTRUCTION_DSS(0, stores, constraints, &accelerated[0], 4); break;
+    case GENERAL: ROCC_INSTRUCTION_DSS(0, stores, constraints, &accelerated[0], 5); break;
+    default: ROCC_INSTRUCTION_DSS(0, stores, constraints, &accelerated[0], 6);
+    }
+    asm volatile ("fence");
+    printf("Accelerator response for kind %d: %lx\n", s->kind, stores);
+    for(i = 0; i < words; i++) {
+        if(accelerated[i] != buffer[i]) {
+            printf("ERROR: kind %d length %ld word %lu: accelerator %lx, software %lx\n", s->kind, s->length, i, accelerated[i], buffer[i]);
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+int main(void) {
+    struct sequence s;
+    long n;
+    int mismatches = 0;
+
+    for(n = 1; n <= MAX_LENGTH; n++) {
+        s.length = n;
+        s.kind = FIXED_WEIGHT;
+        s.min = s.max = (n + 1)/2;
+        mismatches += testStream(&s);
+        s.kind = GENERAL;
+        s.min = 0;
+        s.max = n;
+        mismatches += testStream(&s);
+        s.kind = RANGED;
+        s.min = n/4;
+        s.max = n/2 + 1;
+        mismatches += testStream(&s);
+    }
+    printf("Packed stream mismatches: %d\n", mismatches);
+
+    s.length = 11; //Strings straddle words
+    s.kind = FIXED_WEIGHT;
+    s.min = s.max = 5;
+    mismatches += testAccelerator(&s);
+    s.kind = GENERAL;
+    s.min = 0;
+    s.max = 11;
+    mismatches += testAccelerator(&s);
+    s.kind = RANGED;
+    s.min = 2;
+    s.max = 6;
+    mismatches += testAccelerator(&s);
+    printf("Total packed mismatches: %d\n", mismatches);
+    return mismatches;
+}
@@ -0,0 +1,102 @@
+// Tests for storing a range of a sequence, as each of several processors would
+// (c) Maddie Burbage, 2020
+
+#include "rocc.h"
+#include "combinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GUARD 0xa5a5a5a5a5a5a5a5 //Fills the buffer before each range
+#define MAX_STRINGS 1024
+
+static unsigned long buffer[MAX_STRINGS + 1];
+
+//Has the accelerator store the strings of a sequence from start up to end
+static void storeRange(const struct sequence *s, unsigned long start, unsigned long end) {
+    unsigned long constraints = s->length | (s->min << 6) | (s->max << 12), index, out;
+
+    for(index = 0; index <= MAX_STRINGS; index++) {
+        buffer[index] = GUARD;
+    }
+    asm volatile ("fence");
+    ROCC_INSTRUCTION_DSS(0, out, start, end, RANGE);
+    switch(s->kind) {
+    case FIXED_WEIGHT: ROCC_INSTRUCTION_DSS(0, out, constraints, &buffer[0], FIXED_WEIGHT + 4); break;
+    case GENERAL: ROCC_INSTRUCTION_DSS(0, out, constraints, &buffer[0], GENERAL + 4); break;
+    default: ROCC_INSTRUCTION_DSS(0, out, constraints, &buffer[0], RANGED + 4);
+    }
+    (void) out;
+}
+
+//Checks that the buffer holds count strings of a sequence from a rank, and nothing after
+static int checkRange(const struct sequence *s, unsigned long rank, unsigned long count) {
+    unsigned long string = sequenceString(s, rank), index;
+    unsigned int next = 0;
+    int mismatches = 0;
+
+    for(index = 0; index < count; index++) {
+        if(buffer[index] != string) {
+            mismatches++;
+        }
+        sequenceNext(s, string, &next);
+        string = next;
+    }
+    if(buffer[count] != GUARD) {
+        mismatches++;
+    }
+    return mismatches;
+}
+
+/* Splits a sequence into slices, stored one at a time as separate processors
+ * would, and checks each slice. Then stores ranges given by a count, finding
+ * their ends with the jump-ahead function.
+ */
+static int testRanges(const struct sequence *s, unsigned long slices) {
+    unsigned long constraints = s->length | (s->min << 6) | (s->max << 12), length = sequenceLength(s);
+    unsigned long slice, start, end, rank, count;
+    int errors, mismatches = 0;
+
+    for(slice = 0; slice < slices; slice++) {
+        sequenceSlice(s, slice, slices, &start, &end);
+        storeRange(s, start, end);
+        rank = length * slice / slices;
+        errors = checkRange(s, rank, length * (slice + 1) / slices - rank);
+        if(errors != 0) {
+            printf("ERROR: kind %d slice %lu of %lu\n", s->kind, slice, slices);
+            mismatches += errors;
+        }
+    }
+
+    count = length / slices + 1;
+    for(rank = 0; rank < length; rank += count) {
+        start = sequenceString(s, rank);
+        switch(s->kind) {
+        case FIXED_WEIGHT: ROCC_INSTRUCTION_DSS(0, end, constraints | START_STRING(start), count, FIXED_WEIGHT + JUMP_AHEAD); break;
+        case GENERAL: ROCC_INSTRUCTION_DSS(0, end, constraints | START_STRING(start), count, GENERAL + JUMP_AHEAD); break;
+        default: ROCC_INSTRUCTION_DSS(0, end, constraints | START_STRING(start), count, RANGED + JUMP_AHEAD);
+        }
+        storeRange(s, start, end);
+        errors = checkRange(s, rank, (rank + count < length)? count : length - rank);
+        if(errors != 0) {
+            printf("ERROR: kind %d %lu strings from %lu\n", s->kind, count, rank);
+            mismatches += errors;
+        }
+    }
+    return mismatches;
+}
+
+int main(void) {
+    struct sequence sequences[] = {{FIXED_WEIGHT, 12, 6, 6}, {GENERAL, 10, 0, 10}, {RANGED, 10, 3, 7}};
+    unsigned long slices[] = {1, 2, 3, 8};
+    unsigned int i, j;
+    int mismatches = 0;
+
+    for(i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        for(j = 0; j < sizeof(slices) / sizeof(slices[0]); j++) {
+            mismatches += testRanges(&sequences[i], slices[j]);
+        }
+    }
+    printf("Range mismatches: %d\n", mismatches);
+    return mismatches;
+}
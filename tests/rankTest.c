@@ -0,0 +1,157 @@
+// Tests for ranking and unranking the software combination sequences
+// (c) Maddie Burbage, 2020
+
+#include "combinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FULL_WALK 4096 //Sequences up to this size are checked string by string
+#define SAMPLES 256 //Larger sequences are checked at this many evenly spaced ranks
+
+/* Compares the rank and unrank functions against the successor for every
+ * string of a short sequence, or for sampled strings of a long one. At each
+ * sampled rank, the successor of the unranked string should be the unranked
+ * string at the following rank.
+ */
+static int testWeighted(long n, long k) {
+    unsigned long count, stride, i, string, expected;
+    unsigned int next;
+    int mismatches = 0;
+
+    count = binomial(n, k);
+    stride = (count <= FULL_WALK)? 1 : count / SAMPLES;
+
+    if(unrankWeightedCombination(n, k, 0) != (1L << k) - 1) {
+        mismatches++;
+    }
+    for(i = 0; i < count; i += stride) {
+        string = unrankWeightedCombination(n, k, i);
+        if(rankWeightedCombination(n, string) != i) {
+            printf("ERROR: n %ld k %ld rank %lu string %lx\n", n, k, i, string);
+            mismatches++;
+        }
+        if(nextWeightedCombination(n, string, &next) == -1) {
+            expected = -1;
+            next = -1;
+        } else {
+            expected = (i + 1 < count)? unrankWeightedCombination(n, k, i + 1) : -1;
+        }
+        if((unsigned int) expected != next) {
+            printf("ERROR: n %ld k %ld successor of rank %lu\n", n, k, i);
+            mismatches++;
+        }
+    }
+
+    //The sequence should end right at the last rank
+    string = unrankWeightedCombination(n, k, count - 1);
+    if(nextWeightedCombination(n, string, &next) != -1) {
+        mismatches++;
+    }
+    return mismatches;
+}
+
+/* Checks the cool-er sequence of length n the same way, which starts and ends
+ * with all bits set.
+ */
+static int testGeneral(long n) {
+    unsigned long count, stride, i, string, expected;
+    unsigned int next;
+    int mismatches = 0;
+
+    count = 1L << n;
+    stride = (count <= FULL_WALK)? 1 : count / SAMPLES;
+
+    if(unrankGeneralCombination(n, 0) != count - 1) {
+        mismatches++;
+    }
+    for(i = 0; i < count; i += stride) {
+        string = unrankGeneralCombination(n, i);
+        if(rankGeneralCombination(n, string) != i) {
+            printf("ERROR: n %ld rank %lu string %lx\n", n, i, string);
+            mismatches++;
+        }
+        if(nextGeneralCombination(n, string, &next) == -1) {
+            expected = -1;
+            next = -1;
+        } else {
+            expected = (i + 1 < count)? unrankGeneralCombination(n, i + 1) : -1;
+        }
+        if((unsigned int) expected != next) {
+            printf("ERROR: n %ld successor of rank %lu\n", n, i);
+            mismatches++;
+        }
+    }
+
+    string = unrankGeneralCombination(n, count - 1);
+    if(nextGeneralCombination(n, string, &next) != -1) {
+        mismatches++;
+    }
+    return mismatches;
+}
+
+/* Checks the cool-est sequence of length n with weights from min to max,
+ * which starts and ends with the lowest min bits set.
+ */
+static int testRanged(long n, long min, long max) {
+    unsigned long count, stride, i, string, expected;
+    unsigned int next;
+    int mismatches = 0;
+
+    count = countRangedCombinations(n, min, max);
+    stride = (count <= FULL_WALK)? 1 : count / SAMPLES;
+
+    if(unrankRangedCombination(n, 0, min, max) != (1L << min) - 1) {
+        mismatches++;
+    }
+    for(i = 0; i < count; i += stride) {
+        string = unrankRangedCombination(n, i, min, max);
+        if(rankRangedCombination(n, string, min, max) != i) {
+            printf("ERROR: n %ld min %ld max %ld rank %lu string %lx\n", n, min, max, i, string);
+            mismatches++;
+        }
+        if(nextRangedCombination(n, string, min, max, &next) == -1) {
+            expected = -1;
+            next = -1;
+        } else {
+            expected = (i + 1 < count)? unrankRangedCombination(n, i + 1, min, max) : -1;
+        }
+        if((unsigned int) expected != next) {
+            printf("ERROR: n %ld min %ld max %ld successor of rank %lu\n", n, min, max, i);
+            mismatches++;
+        }
+    }
+
+    string = unrankRangedCombination(n, count - 1, min, max);
+    if(nextRangedCombination(n, string, min, max, &next) != -1) {
+        mismatches++;
+    }
+    return mismatches;
+}
+
+int main(void) {
+    long n, k, min, max;
+    int mismatches = 0;
+
+    for(n = 1; n <= MAX_WIDTH; n++) {
+        for(k = 1; k <= n; k++) {
+            mismatches += testWeighted(n, k);
+        }
+    }
+    printf("Fixed-weight rank mismatches: %d\n", mismatches);
+
+    for(n = 1; n <= MAX_WIDTH; n++) {
+        mismatches += testGeneral(n);
+    }
+    printf("Total rank mismatches with general: %d\n", mismatches);
+
+    for(n = 1; n <= MAX_WIDTH; n++) {
+        for(min = 0; min <= n; min++) {
+            for(max = min; max <= n; max++) {
+                mismatches += testRanged(n, min, max);
+            }
+        }
+    }
+    printf("Total rank mismatches with ranged: %d\n", mismatches);
+    return mismatches;
+}
@@ -0,0 +1,54 @@
+// Tests for ranking and unranking strings with the accelerator
+// (c) Maddie Burbage, 2020
+
+#include "rocc.h"
+#include "combinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLES 64 //Ranks checked in each sequence
+
+/* Ranks and unranks sampled strings of a sequence with the accelerator,
+ * checking them against the software, along with the last string and the
+ * positions past the end.
+ */
+static int testRankUnit(const struct sequence *s) {
+    unsigned long constraints = s->length | (s->min << 6) | (s->max << 12) | RANK_KIND(s->kind);
+    unsigned long length = sequenceLength(s), rank, string, out;
+    int i, mismatches = 0;
+
+    for(i = 0; i <= SAMPLES; i++) {
+        rank = (i == SAMPLES)? length - 1 : length / SAMPLES * i;
+        string = sequenceString(s, rank);
+        ROCC_INSTRUCTION_DSS(0, out, constraints, rank, UNRANK);
+        if(out != string) {
+            printf("ERROR: kind %d length %ld unranked %lu as %lx\n", s->kind, s->length, rank, out);
+            mismatches++;
+        }
+        ROCC_INSTRUCTION_DSS(0, out, constraints, string, RANK);
+        if(out != rank) {
+            printf("ERROR: kind %d length %ld ranked %lx as %lu\n", s->kind, s->length, string, out);
+            mismatches++;
+        }
+    }
+    ROCC_INSTRUCTION_DSS(0, out, constraints, length, UNRANK);
+    if(out != 0xffffffff) {
+        mismatches++;
+    }
+    return mismatches;
+}
+
+int main(void) {
+    struct sequence sequences[] = {{FIXED_WEIGHT, 1, 1, 1}, {FIXED_WEIGHT, 8, 3, 3}, {FIXED_WEIGHT, 32, 16, 16}, {FIXED_WEIGHT, 32, 32, 32},
+        {GENERAL, 1, 0, 1}, {GENERAL, 12, 0, 12}, {GENERAL, 32, 0, 32},
+        {RANGED, 10, 0, 4}, {RANGED, 20, 5, 12}, {RANGED, 32, 8, 24}, {RANGED, 32, 0, 32}, {RANGED, 16, 16, 16}};
+    unsigned int i;
+    int mismatches = 0;
+
+    for(i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        mismatches += testRankUnit(&sequences[i]);
+    }
+    printf("Rank unit mismatches: %d\n", mismatches);
+    return mismatches;
+}
@@ -0,0 +1,72 @@
+// Consumer helpers for the ring functions, which stream a sequence through a ring buffer
+// (c) Maddie Burbage, 2020
+
+#ifndef __RING_COMBINATIONS_H
+#define __RING_COMBINATIONS_H
+
+#include "rocc.h"
+#include "combinations.h"
+
+/* A ring function (36-38) stores the strings of a sequence as 64-bit values
+ * into a ring of slots, returning at once. The ring starts with a head word,
+ * which the accelerator sets to the number of strings stored each time it
+ * fills half of the ring, with the top bit set once the whole sequence is
+ * stored, and a tail word, which the processor sets to the number of strings
+ * it has read. The accelerator only fills a half again once the processor
+ * has read it, so a sequence of any length streams through a ring that stays
+ * in the cache.
+ */
+#define RING 32 //Added to functions 4-6 to stream into a ring
+#define RING_SLOTS(logSlots) ((long) (logSlots) << 22) //Set in register 1 for a ring of 2^logSlots slots, from 2 to 2^16
+
+struct combinationRing {
+    volatile unsigned long head;
+    volatile unsigned long tail;
+    unsigned long slots[]; //2^logSlots strings
+};
+
+/* Empties a ring and starts the accelerator streaming a sequence into it.
+ * Returns 0, or -1 without starting when logSlots is outside 1-16.
+ */
+static inline int startRing(struct combinationRing *ring, const struct sequence *s, long logSlots) {
+    unsigned long constraints = s->length | (s->min << 6) | (s->max << 12) | RING_SLOTS(logSlots), response;
+
+    if(logSlots < 1 || logSlots > 16) {
+        return -1;
+    }
+    ring->head = 0;
+    ring->tail = 0;
+    asm volatile ("fence" ::: "memory");
+    switch(s->kind) {
+    case FIXED_WEIGHT: ROCC_INSTRUCTION_DSS(0, response, constraints, ring, 4 + RING); break;
+    case GENERAL: ROCC_INSTRUCTION_DSS(0, response, constraints, ring, 5 + RING); break;
+    default: ROCC_INSTRUCTION_DSS(0, response, constraints, ring, 6 + RING);
+    }
+    (void) response;
+    return 0;
+}
+
+/* Waits for strings past the tail of a ring, and points strings at them.
+ * Returns how many can be read in place, up to the end of the ring, or 0
+ * once every string of the sequence has been read.
+ */
+static inline unsigned long readRing(struct combinationRing *ring, long logSlots, const unsigned long **strings) {
+    unsigned long head, tail = ring->tail, slot = tail & ((1UL << logSlots) - 1), count;
+
+    do {
+        head = ring->head;
+    } while((head & ~LONGTOP) == tail && !(head & LONGTOP));
+    asm volatile ("fence" ::: "memory"); //Read the strings only after the head
+    count = (head & ~LONGTOP) - tail;
+    *strings = &ring->slots[slot];
+    return (slot + count > (1UL << logSlots))? (1UL << logSlots) - slot : count;
+}
+
+/* Hands strings read from a ring back to the accelerator.
+ */
+static inline void releaseRing(struct combinationRing *ring, unsigned long count) {
+    asm volatile ("fence" ::: "memory"); //Finish reading the strings before they can be stored over
+    ring->tail += count;
+}
+
+#endif //__RING_COMBINATIONS_H
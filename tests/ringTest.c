@@ -0,0 +1,64 @@
+// Tests for the ring functions and their consumer helpers
+// (c) Maddie Burbage, 2020
+
+#include "ringCombinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LOG_SLOTS 8
+
+static struct {
+    struct combinationRing ring;
+    unsigned long slots[1 << MAX_LOG_SLOTS];
+} buffer;
+
+/* Streams a whole sequence through a ring, reading the strings in parts of
+ * varying size, and checks them against the software sequence.
+ */
+static int testRing(const struct sequence *s, long logSlots) {
+    const unsigned long *strings;
+    unsigned long count, index, total = 0, part = 1, string;
+    unsigned int next = 0;
+    int mismatches = 0;
+
+    startRing(&buffer.ring, s, logSlots);
+    string = sequenceString(s, 0);
+    while((count = readRing(&buffer.ring, logSlots, &strings)) != 0) {
+        count = (count > part)? part : count;
+        for(index = 0; index < count; index++) {
+            if(strings[index] != string) {
+                mismatches++;
+            }
+            sequenceNext(s, string, &next);
+            string = next;
+        }
+        releaseRing(&buffer.ring, count);
+        total += count;
+        part = part % 13 + 3;
+    }
+    if(total != sequenceLength(s)) {
+        printf("ERROR: kind %d read %lu strings through %d slots\n", s->kind, total, 1 << logSlots);
+        mismatches++;
+    }
+    return mismatches;
+}
+
+int main(void) {
+    struct sequence sequences[] = {{FIXED_WEIGHT, 12, 6, 6}, {GENERAL, 11, 0, 11}, {RANGED, 12, 3, 7}};
+    long logSlots[] = {1, 5, MAX_LOG_SLOTS};
+    unsigned int i, j;
+    int mismatches = 0;
+
+    for(i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        for(j = 0; j < sizeof(logSlots) / sizeof(logSlots[0]); j++) {
+            mismatches += testRing(&sequences[i], logSlots[j]);
+        }
+    }
+    if(startRing(&buffer.ring, &sequences[0], 0) != -1 || startRing(&buffer.ring, &sequences[0], 17) != -1) {
+        printf("ERROR: a ring outside 1-16 slot logs was started\n");
+        mismatches++;
+    }
+    printf("Ring mismatches: %d\n", mismatches);
+    return mismatches;
+}
@@ -0,0 +1,54 @@
+#!/bin/bash
+
+#Runs the accelerator tests on a Verilator simulator built from chipyard with CombinationsRocketConfig, given as SIM.
+#Each test returns its number of mismatches, which the simulator exits with. coreTests runs on one hart with the
+#software and the accelerator, and on four harts too when CORESIM names a simulator built with
+#CombinationsQuadRocketConfig. The last line of each coreTests run is collected in coreTests.out.
+SIM=${SIM:-simulator-chipyard-CombinationsRocketConfig}
+TESTS=(memoryTest storeSizeTest deltaTest packedTest completionTest chunkTest asyncTest ringTest cursorTest jumpTest rankUnitTest rangeTest)
+FAILED=0
+
+for TEST in ${TESTS[@]}; do
+    make $TEST.riscv
+    if $SIM $TEST.riscv > $TEST.out; then
+        echo Passed $TEST
+    else
+        echo FAILED $TEST, see $TEST.out
+        let FAILED=$FAILED+1
+    fi
+done
+
+#Each sequence split between the harts, in software and with each hart's accelerator
+rm -f coreTests.out
+export WIDTH=16
+for NCORES in 1 4; do
+    CORES=$SIM
+    if [ $NCORES -gt 1 ]; then
+        if [ -z "$CORESIM" ]; then
+            break
+        fi
+        CORES=$CORESIM
+    fi
+    export NCORES
+    rm -f crt.o #The start-up code starts NCORES harts
+    for FUNCT in 0 1 2; do
+        export FUNCT
+        for WARE in 0 1; do
+            export WARE
+            rm -f coreTests.o
+            make coreTests.riscv
+            OUT=coreTests-$FUNCT-$WARE-${NCORES}core.out
+            if $CORES coreTests.riscv > $OUT; then
+                echo Passed coreTests for function $FUNCT, ware $WARE, $NCORES harts
+            else
+                echo FAILED coreTests for function $FUNCT, ware $WARE, $NCORES harts, see $OUT
+                let FAILED=$FAILED+1
+            fi
+            tail -n 1 $OUT >> coreTests.out
+        done
+    done
+done
+rm -f crt.o coreTests.o
+
+echo $FAILED tests failed
+exit $FAILED
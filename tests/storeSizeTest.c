@@ -0,0 +1,74 @@
+// Tests for the element sizes of the memory functions
+// (c) Maddie Burbage, 2020
+
+#include "rocc.h"
+#include "combinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GUARD 0xa5 //Fills the bytes around the stored strings
+
+static unsigned char buffer[(1 << 8) * 8 + 64] __attribute__((aligned(8)));
+
+//Reads the string stored at an index with the given element size
+static unsigned long storedString(const unsigned char *elements, unsigned long index, int bytes) {
+    switch(bytes) {
+    case 1: return elements[index];
+    case 2: return ((const unsigned short *) elements)[index];
+    case 4: return ((const unsigned int *) elements)[index];
+    default: return ((const unsigned long *) elements)[index];
+    }
+}
+
+/* Has the accelerator store a sequence with each element size, then checks
+ * every string and that nothing was stored past the last element.
+ */
+static int testSize(const struct sequence *s, int bytes) {
+    unsigned long constraints, count, index, string, stores = 0;
+    unsigned int next = 0;
+    int mismatches = 0;
+
+    constraints = s->length | (s->min << 6) | (s->max << 12) | STORE_BYTES(bytes);
+    count = sequenceLength(s);
+    memset(buffer, GUARD, sizeof(buffer));
+    asm volatile ("fence");
+    switch(s->kind) {
+    case FIXED_WEIGHT: ROCC_INSTRUCTION_DSS(0, stores, constraints, &buffer[0], 4); break;
+    case GENERAL: ROCC_INSTRUCTION_DSS(0, stores, constraints, &buffer[0], 5); break;
+    default: ROCC_INSTRUCTION_DSS(0, stores, constraints, &buffer[0], 6);
+    }
+    asm volatile ("fence");
+    printf("Accelerator response for kind %d, %d bytes: %lx\n", s->kind, bytes, stores);
+
+    string = sequenceString(s, 0);
+    for(index = 0; index < count; index++) {
+        if(storedString(buffer, index, bytes) != string) {
+            printf("ERROR: kind %d, %d bytes, string %lu\n", s->kind, bytes, index);
+            mismatches++;
+        }
+        sequenceNext(s, string, &next);
+        string = next;
+    }
+    for(index = count * bytes; index < count * bytes + 16; index++) {
+        if(buffer[index] != GUARD) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+int main(void) {
+    //The fixed-weight and ranged sequences end partway through a group of a multi-lane accelerator
+    struct sequence sequences[] = {{FIXED_WEIGHT, 8, 4, 4}, {GENERAL, 8, 0, 8}, {RANGED, 8, 2, 5}};
+    unsigned int i;
+    int bytes, mismatches = 0;
+
+    for(i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        for(bytes = 1; bytes <= 8; bytes *= 2) {
+            mismatches += testSize(&sequences[i], bytes);
+        }
+    }
+    printf("Store size mismatches: %d\n", mismatches);
+    return mismatches;
+}
@@ -0,0 +1,57 @@
+// Table-driven software successors for strings up to 16 bits long
+// (c) Maddie Burbage, 2020
+
+#ifndef __TABLE_COMBINATIONS_H
+#define __TABLE_COMBINATIONS_H
+
+#include "combinations.h"
+#include <stdint.h>
+
+#define TABLE_WIDTH 16 //The longest strings a table can hold
+
+/* The successor of every string in a sequence, indexed by the string itself.
+ * Every sequence is a cycle, so the last string's entry is the first string
+ * and the walk ends when it comes back around. Entries for strings outside
+ * the sequence are unused. At 16 bits a table takes 128KB.
+ */
+struct successorTable {
+    struct sequence sequence;
+    uint16_t first;
+    uint16_t next[1 << TABLE_WIDTH];
+};
+
+/* Fills a table by walking the sequence once with the arithmetic successor.
+ * Returns 0 for strings too long to tabulate, or 1 once built.
+ */
+static inline int buildSuccessorTable(struct successorTable *t, const struct sequence *s) {
+    unsigned long string;
+    unsigned int next;
+
+    if(s->length > TABLE_WIDTH) {
+        return 0;
+    }
+    t->sequence = *s;
+    t->first = string = sequenceString(s, 0);
+    while(sequenceNext(s, string, &next) != -1) {
+        t->next[string] = next;
+        string = next;
+    }
+    t->next[string] = t->first;
+    return 1;
+}
+
+/* Loads the next combination from a table, in the same form as
+ * nextWeightedCombination and friends: -1 is returned when the pattern ends.
+ */
+static inline int nextTableCombination(const struct successorTable *t, unsigned long last, unsigned int *out) {
+    unsigned int result = t->next[last];
+
+    if(result == t->first) {
+        return -1;
+    }
+
+    *out = result;
+    return 1;
+}
+
+#endif //__TABLE_COMBINATIONS_H
@@ -0,0 +1,57 @@
+// Tests for the table-driven software successors
+// (c) Maddie Burbage, 2020
+
+#include "tableCombinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct successorTable table;
+
+/* Walks a sequence with both the table and the arithmetic successor,
+ * counting every step where they disagree.
+ */
+static int testTable(const struct sequence *s) {
+    unsigned long string;
+    unsigned int expected, found;
+    int mismatches = 0, more;
+
+    buildSuccessorTable(&table, s);
+    string = sequenceString(s, 0);
+    do {
+        expected = found = 0;
+        more = sequenceNext(s, string, &expected);
+        if(nextTableCombination(&table, string, &found) != more || expected != found) {
+            mismatches++;
+        }
+        string = expected;
+    } while(more != -1);
+    return mismatches;
+}
+
+int main(void) {
+    struct sequence s;
+    long n;
+    int mismatches = 0;
+
+    for(n = 1; n <= TABLE_WIDTH; n++) {
+        s.length = n;
+        s.kind = FIXED_WEIGHT;
+        s.min = s.max = (n + 1)/2;
+        mismatches += testTable(&s);
+        s.kind = GENERAL;
+        s.min = 0;
+        s.max = n;
+        mismatches += testTable(&s);
+        s.kind = RANGED;
+        s.min = 0;
+        s.max = n/2;
+        mismatches += testTable(&s);
+    }
+    s.length = TABLE_WIDTH + 1;
+    if(buildSuccessorTable(&table, &s)) {
+        mismatches++;
+    }
+    printf("Table mismatches: %d\n", mismatches);
+    return mismatches;
+}
@@ -3,109 +3,36 @@
 
 #include "rocc.h"
 #include "encoding.h"
+#include "widthCombinations.h"
+#include "tableCombinations.h"
+#include "deltaCombinations.h"
+#include "packedCombinations.h"
+#include "ringCombinations.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define LONGTOP 0x8000000000000000
-/* A function to help generate all binary strings of a certain weight.
- * Input the length of the binary string and the previous combination.
- * The pointer, out, will be loaded with the next combination following
- * the suffix-rotation pattern. -1 is returned when the pattern ends.
- * Generation is computed using Knuth's variant on the cool pattern from
- * The Art of Computer Programming, volume 4, fascicle 3.
- */
-int nextWeightedCombination(long n, unsigned long last, unsigned int *out) {
-    unsigned long next, temp, result;
-    next = last & (last + 1); //Discards trailing ones
-    temp = next ^ (next - 1); //Marks the start of the last "10"
-
-    next = temp + 1;
-    temp = temp & last;
-
-    next = (next & last) - 1;
-
-    next = (next < LONGTOP)? next : 0;
-
-    result = last + temp - next;
-
-    if(result / (1L << n) > 0) {
-        return -1;
-    }
-
-    *out = result % (1L << n);
-    return 1;
-}
-
-/* A function to help generate all binary strings of a certain length.
- * The generation is computed using the cool-er pattern from "The Coolest
- * Way to Generate Binary Strings"
- */
-int nextGeneralCombination(long n, unsigned long last, unsigned int *out) {
-  unsigned long cut, trimmed, trailed, mask, lastTemp, lastLimit, lastPosition, cap, first, shifted, rotated, result;
-
-    cut = last >> 1;
-    trimmed = cut | (cut - 1); //Discards trailing zeros
-    trailed = trimmed ^ (trimmed + 1); //Marks the start of the last "01"
-    mask = (trailed << 1) + 1;
-
-    lastTemp = trailed + 1; //Indexes the start of the last "01"
-    lastLimit = 1L << (n-1); //Indexes the length of the string
-    lastPosition = (lastTemp == 0 || lastTemp > lastLimit)? lastLimit : lastTemp;
-
-    cap = 1L << n;
-    first = (mask < cap)? 1 & last : 1 & ~(last); //The bit to be moved
-    shifted = cut & trailed;
-    rotated = (first == 1)? shifted | lastPosition : shifted;
-    result = rotated | (~mask & last);
-
-    if(result == cap - 1) {
-        return -1;
-    }
-
-    *out = result;
-    return 1;
-}
-
-/* A function to help generate all binary strings of a certain length and weight range
- * The generation is computed using the cool-est pattern from "The Coolest
- * Way to Generate Binary Strings"
- */
-int nextRangedCombination(long n, unsigned long last, long min, long max, unsigned int *out) {
-  unsigned long cut, trimmed, trailed, mask, lastTemp, lastLimit, lastPosition, disposable, count, cap, flipped, valid, first, shifted, rotated, result;
-    cut = last >> 1;
-    trimmed = cut | (cut - 1); //Discards trailing zeros
-    trailed = trimmed ^ (trimmed + 1); //Marks the start of the last "01"
-    mask = (trailed << 1) + 1;
-
-    lastTemp = trailed + 1; //Indexes the start of the last "01"
-    lastLimit = 1L << (n-1); //Indexes the length of the string
-    lastPosition = (lastTemp == 0 || lastTemp > lastLimit)? lastLimit : lastTemp;
-
-    disposable = last; //Prepare to count bits set in the string
-    for(count = 0; disposable; count++) {
-        disposable = disposable & (disposable - 1); //Discard the last bit set
-    }
-
-    cap = 1L << n;
-    flipped = 1 & ~last;
-    valid = (flipped == 0)? count > min : count < max;
-    first = (mask < cap || !valid)? 1 & last : flipped; //The bit to be moved
-    shifted = cut & trailed;
-    rotated = (first == 1)? shifted | lastPosition : shifted;
-    result = rotated | (~mask & last);
-
-    cap = (1L << min) - 1;
-    if(result == cap) {
-        return -1;
-    }
-
-    *out = result;
-    return 1;
-}
+#if WARE == 2 //Software with the width and weight range fixed when compiling
+SPECIALIZE_RANGE(timedRangedCombination, WIDTH, 0, WIDTH/2)
+#define nextTimedWeighted(n, last, out) WIDTH_SUCCESSOR(nextWeightedCombination, WIDTH)(last, out)
+#define nextTimedGeneral(n, last, out) WIDTH_SUCCESSOR(nextGeneralCombination, WIDTH)(last, out)
+#define nextTimedRanged(n, last, min, max, out) timedRangedCombination(last, out)
+#elif WARE == 4 //Software stepping through a table built before timing starts
+static struct successorTable table;
+#define nextTimedWeighted(n, last, out) nextTableCombination(&table, last, out)
+#define nextTimedGeneral(n, last, out) nextTableCombination(&table, last, out)
+#define nextTimedRanged(n, last, min, max, out) nextTableCombination(&table, last, out)
+#else
+#define nextTimedWeighted nextWeightedCombination
+#define nextTimedGeneral nextGeneralCombination
+#define nextTimedRanged nextRangedCombination
+#endif
 
 static inline int timeHardware(unsigned int inputString, int length, long answer) {
-    unsigned int outputString, outputs;
+    unsigned int outputs;
+    #if FUNCT < 32 || FUNCT > 63 //Ring stores have no response to read
+    unsigned int outputString;
+    #endif
 
     outputs = 1;
 
@@ -122,41 +49,96 @@ static inline int timeHardware(unsigned int inputString, int length, long answer
 	outputs++;
         ROCC_INSTRUCTION_DSS(0, outputString, length, inputString, FUNCT);
     }
+    #elif FUNCT > 63 //A cursor that keeps the last string, so each step only names the cursor
+    ROCC_INSTRUCTION_DSS(0, outputString, length | START_STRING(inputString), 0, FUNCT);
+    ROCC_INSTRUCTION_DSS(0, outputString, 0, 0, CURSOR_NEXT);
+    while(outputString != -1) {
+	outputs++;
+        ROCC_INSTRUCTION_DSS(0, outputString, 0, 0, CURSOR_NEXT);
+    }
+    #elif FUNCT > 31 //Ring stores, read back through a ring that stays in the cache
+    static struct {
+        struct combinationRing ring;
+        unsigned long slots[1 << 9];
+    } buffer;
+    #if FUNCT % 4 == 2
+    struct sequence s = {RANGED, length, 0, WIDTH/2};
     #else
-    unsigned long streamOut[answer];
-    ROCC_INSTRUCTION_DSS(0, outputString, length, &streamOut[0], FUNCT);
+    struct sequence s = {FUNCT % 4, length, WIDTH/2, WIDTH/2};
+    #endif
+    const unsigned long *strings;
+    unsigned long count, read = 0;
+    startRing(&buffer.ring, &s, 9);
+    while((count = readRing(&buffer.ring, 9, &strings)) != 0) {
+        releaseRing(&buffer.ring, count);
+        read += count;
+    }
+    outputs = (read == answer)? 0 : -1;
+    #elif FUNCT > 7 //Bounded stores, in chunks that reuse one buffer
+    unsigned long streamOut[CHUNK_STRINGS], chunks = 0;
+    outputString = inputString;
+    while(outputString != CHUNK_DONE) {
+        ROCC_INSTRUCTION_DSS(0, outputString, length | CHUNK_CONSTRAINTS(CHUNK_STRINGS, outputString), &streamOut[0], FUNCT);
+        chunks++;
+    }
+    outputs = (chunks == (answer + CHUNK_STRINGS - 1) / CHUNK_STRINGS)? 0 : -1;
+    #elif FORMAT == 1 //Delta-encoded stores
+    unsigned long streamOut[deltaStreamBytes(answer) / 8];
+    ROCC_INSTRUCTION_DSS(0, outputString, length | DELTA_FORMAT, &streamOut[0], FUNCT);
+    outputs = outputString;
+    #elif FORMAT == 2 //Bit-packed stores
+    unsigned long streamOut[packedStreamBytes(answer, WIDTH) / 8];
+    ROCC_INSTRUCTION_DSS(0, outputString, length | PACKED_FORMAT, &streamOut[0], FUNCT);
+    outputs = outputString;
+    #else
+    unsigned long streamOut[(answer * BYTES + 7) / 8];
+    ROCC_INSTRUCTION_DSS(0, outputString, length | STORE_BYTES(BYTES), &streamOut[0], FUNCT);
     outputs = outputString;
     #endif
     return outputs;
 }
 
 static inline int timeSoftware(unsigned int inputString, int length, long answer) {
-    unsigned int outputString, outputs;
+    unsigned int outputs;
     outputs = 1;
     #if FUNCT < 3
+    unsigned int outputString;
     while(
 	  #if FUNCT % 4 == 0
-	  nextWeightedCombination(length, inputString, &outputString)
+	  nextTimedWeighted(length, inputString, &outputString)
 	  #elif FUNCT % 4 == 1
-	  nextGeneralCombination(length, inputString, &outputString)
+	  nextTimedGeneral(length, inputString, &outputString)
 	  #else
-	  nextRangedCombination(length, inputString, 0, WIDTH/2, &outputString)
+	  nextTimedRanged(length, inputString, 0, WIDTH/2, &outputString)
           #endif
 	  != -1) {
 	inputString = outputString;
 	//printf("%d \n", outputString);
 	outputs++;
     }
+    #elif FORMAT == 1 || FORMAT == 2 //Delta-encoded or bit-packed stores
+    #if FUNCT % 4 == 2
+    struct sequence s = {RANGED, length, 0, WIDTH/2};
+    #else
+    struct sequence s = {FUNCT % 4, length, WIDTH/2, WIDTH/2};
+    #endif
+    #if FORMAT == 1
+    unsigned long streamOut[deltaStreamBytes(answer) / 8];
+    outputs = (writeDeltaStream((unsigned char *) streamOut, &s) == deltaStreamBytes(answer))? 0 : -1;
+    #else
+    unsigned long streamOut[packedStreamBytes(answer, WIDTH) / 8];
+    outputs = (writePackedStream(streamOut, &s) == packedStreamBytes(answer, WIDTH))? 0 : -1;
+    #endif
     #else
     unsigned int streamOut[answer];
     int i = 0;
     while(
 	  #if FUNCT % 4 == 0
-	  nextWeightedCombination(length, inputString, &streamOut[i])
+	  nextTimedWeighted(length, inputString, &streamOut[i])
 	  #elif FUNCT % 4 == 1
-	  nextGeneralCombination(length, inputString, &streamOut[i])
+	  nextTimedGeneral(length, inputString, &streamOut[i])
 	  #else
-	  nextRangedCombination(length, inputString, 0, WIDTH/2, &streamOut[i])
+	  nextTimedRanged(length, inputString, 0, WIDTH/2, &streamOut[i])
           #endif
 	  != -1) {
 	inputString = streamOut[i];
@@ -168,38 +150,72 @@ static inline int timeSoftware(unsigned int inputString, int length, long answer
     return outputs;
 }
 
+/* Counts each string visited by the bulk software */
+static void countString(void *context, unsigned long string) {
+    (*(unsigned int *) context)++;
+}
+
+static inline int timeBulkSoftware(int length, long answer) {
+    unsigned int outputs = 0;
+    #if FUNCT % 4 == 2
+    struct sequence s = {RANGED, length, 0, WIDTH/2};
+    #else
+    struct sequence s = {FUNCT % 4, length, WIDTH/2, WIDTH/2};
+    #endif
+    #if FUNCT < 3
+    visitCombinations(&s, countString, &outputs);
+    #else
+    unsigned long streamOut[answer];
+    struct sequenceState state;
+    startCombinations(&state, &s, 0);
+    outputs = (fillCombinations(streamOut, answer, &state) == answer)? 0 : -1;
+    #endif
+    return outputs;
+}
+
 int main(void) {
     long startCycle, endCycle;
     //Set input string and the expected number of combinations
     #if FUNCT % 4 == 1 //General combinations
-    unsigned long inputString = (1L << WIDTH) - 1;
+    #define INPUT_STRING ((1L << WIDTH) - 1)
     long answer = 1L << WIDTH;
     #elif FUNCT % 4 == 0 //Fixed weight combinations
-    unsigned long inputString = (1L << WIDTH/2) - 1;
-    long lookups[] = {0,0, 2, 0, 6, 0, 20, 0, 70, 0,0,0,0, 1716, 3432,0, 12870,0,0,0, 184756,0,0,0, 2704156,0,0,0,0,0,0,0,601080390};
-    long answer = lookups[WIDTH];
+    #define INPUT_STRING ((1L << WIDTH/2) - 1)
+    long answer = binomial(WIDTH, WIDTH/2);
     #else //Ranged weight combinations
-    unsigned long inputString = 0;
-    long lookups[] = {0,0, 3, 0, 11, 0, 42, 0, 163, 0,0,0,0, 4096, 9908,0, 39203,0,0,0, 616666,0,0,0, 9740686,0,0,0,0,0,0,0, 2448023843};
-    long answer = lookups[WIDTH];
+    #define INPUT_STRING 0
+    long answer = countRangedCombinations(WIDTH, 0, WIDTH/2);
     #endif
     
-    //printf("answer %lu, input %lu \n", answer, inputString);
+    //printf("answer %lu, input %lu \n", answer, INPUT_STRING);
     //Set the string's length
     int length = WIDTH;
 
+    #if WARE == 4
+    #if FUNCT % 4 == 2
+    struct sequence s = {RANGED, length, 0, WIDTH/2};
+    #else
+    struct sequence s = {FUNCT % 4, length, WIDTH/2, WIDTH/2};
+    #endif
+    if(!buildSuccessorTable(&table, &s)) {
+        return -1;
+    }
+    #endif
+
     asm volatile ("fence");
     startCycle = rdcycle();
     #if WARE == 1
-    int testResult = timeHardware(inputString, length, answer);
+    int testResult = timeHardware(INPUT_STRING, length, answer);
+    #elif WARE == 3
+    int testResult = timeBulkSoftware(length, answer);
     #else
-    int testResult = timeSoftware(inputString, length, answer);
+    int testResult = timeSoftware(INPUT_STRING, length, answer);
     #endif
     asm volatile ("fence");
     endCycle = rdcycle();
     printf("%d, %lu \n", WIDTH, endCycle-startCycle);
 
-    #if FUNCT < 3
+    #if FUNCT < 3 || FUNCT > 63
     testResult -= answer;
     #endif
     return testResult;
@@ -0,0 +1,365 @@
+// Software combination sequences for strings up to 64 and 128 bits long
+// (c) Maddie Burbage, 2020
+
+#ifndef __WIDE_COMBINATIONS_H
+#define __WIDE_COMBINATIONS_H
+
+#include "combinations.h"
+
+#define WIDE_WIDTH 128
+
+typedef unsigned __int128 uint128;
+
+/* The 64-bit successors follow nextWeightedCombination and friends, but store
+ * full 64-bit strings and avoid shifting by the width, which is undefined at
+ * 64 bits. The 128-bit successors are the same with the 128-bit type.
+ */
+
+//The lowest count bits set, for counts up to 64
+static inline unsigned long lowBits64(long count) {
+    return (count >= 64)? ~0UL : (1UL << count) - 1;
+}
+
+static inline uint128 lowBits128(long count) {
+    return (count >= 128)? ~(uint128) 0 : ((uint128) 1 << count) - 1;
+}
+
+/* A function to help generate all binary strings of a certain weight, up to
+ * 64 bits long. The pattern ends when the rotated string carries past the
+ * top of the string, which is found from the carry out of the addition.
+ */
+static inline int nextWeightedCombination64(long n, unsigned long last, unsigned long *out) {
+    unsigned long next, temp, sum, result;
+    int carried;
+    next = last & (last + 1); //Discards trailing ones
+    temp = next ^ (next - 1); //Marks the start of the last "10"
+
+    next = temp + 1;
+    temp = temp & last;
+
+    next = (next & last) - 1;
+
+    next = (next < LONGTOP)? next : 0;
+
+    carried = __builtin_add_overflow(last, temp, &sum);
+    result = sum - next;
+
+    if((carried && sum >= next) || (result & ~lowBits64(n))) {
+        return -1;
+    }
+
+    *out = result;
+    return 1;
+}
+
+/* A function to help generate all binary strings of a certain length, up to
+ * 64 bits long, in the cool-er pattern. There is a valid "01" to rotate when
+ * the mask ends below the last bit of the string.
+ */
+static inline int nextGeneralCombination64(long n, unsigned long last, unsigned long *out) {
+    unsigned long cut, trimmed, trailed, mask, lastTemp, lastLimit, lastPosition, first, shifted, rotated, result;
+
+    cut = last >> 1;
+    trimmed = cut | (cut - 1); //Discards trailing zeros
+    trailed = trimmed ^ (trimmed + 1); //Marks the start of the last "01"
+    mask = (trailed << 1) + 1;
+
+    lastTemp = trailed + 1; //Indexes the start of the last "01"
+    lastLimit = 1UL << (n-1); //Indexes the length of the string
+    lastPosition = (lastTemp == 0 || lastTemp > lastLimit)? lastLimit : lastTemp;
+
+    first = (trailed < lastLimit)? 1 & last : 1 & ~(last); //The bit to be moved
+    shifted = cut & trailed;
+    rotated = (first == 1)? shifted | lastPosition : shifted;
+    result = rotated | (~mask & last);
+
+    if(result == lowBits64(n)) {
+        return -1;
+    }
+
+    *out = result;
+    return 1;
+}
+
+/* A function to help generate all binary strings of a certain length and
+ * weight range, up to 64 bits long, in the cool-est pattern.
+ */
+static inline int nextRangedCombination64(long n, unsigned long last, long min, long max, unsigned long *out) {
+    unsigned long cut, trimmed, trailed, mask, lastTemp, lastLimit, lastPosition, flipped, valid, first, shifted, rotated, result;
+    long count;
+
+    cut = last >> 1;
+    trimmed = cut | (cut - 1); //Discards trailing zeros
+    trailed = trimmed ^ (trimmed + 1); //Marks the start of the last "01"
+    mask = (trailed << 1) + 1;
+
+    lastTemp = trailed + 1; //Indexes the start of the last "01"
+    lastLimit = 1UL << (n-1); //Indexes the length of the string
+    lastPosition = (lastTemp == 0 || lastTemp > lastLimit)? lastLimit : lastTemp;
+
+    count = __builtin_popcountl(last);
+    flipped = 1 & ~last;
+    valid = (flipped == 0)? count > min : count < max;
+    first = (trailed < lastLimit || !valid)? 1 & last : flipped; //The bit to be moved
+    shifted = cut & trailed;
+    rotated = (first == 1)? shifted | lastPosition : shifted;
+    result = rotated | (~mask & last);
+
+    if(result == lowBits64(min)) {
+        return -1;
+    }
+
+    *out = result;
+    return 1;
+}
+
+static inline int nextWeightedCombination128(long n, uint128 last, uint128 *out) {
+    uint128 next, temp, sum, result;
+    int carried;
+    next = last & (last + 1); //Discards trailing ones
+    temp = next ^ (next - 1); //Marks the start of the last "10"
+
+    next = temp + 1;
+    temp = temp & last;
+
+    next = (next & last) - 1;
+
+    next = (next >> 127)? 0 : next;
+
+    carried = __builtin_add_overflow(last, temp, &sum);
+    result = sum - next;
+
+    if((carried && sum >= next) || (result & ~lowBits128(n))) {
+        return -1;
+    }
+
+    *out = result;
+    return 1;
+}
+
+static inline int nextGeneralCombination128(long n, uint128 last, uint128 *out) {
+    uint128 cut, trimmed, trailed, mask, lastTemp, lastLimit, lastPosition, first, shifted, rotated, result;
+
+    cut = last >> 1;
+    trimmed = cut | (cut - 1); //Discards trailing zeros
+    trailed = trimmed ^ (trimmed + 1); //Marks the start of the last "01"
+    mask = (trailed << 1) + 1;
+
+    lastTemp = trailed + 1; //Indexes the start of the last "01"
+    lastLimit = (uint128) 1 << (n-1); //Indexes the length of the string
+    lastPosition = (lastTemp == 0 || lastTemp > lastLimit)? lastLimit : lastTemp;
+
+    first = (trailed < lastLimit)? 1 & last : 1 & ~(last); //The bit to be moved
+    shifted = cut & trailed;
+    rotated = (first == 1)? shifted | lastPosition : shifted;
+    result = rotated | (~mask & last);
+
+    if(result == lowBits128(n)) {
+        return -1;
+    }
+
+    *out = result;
+    return 1;
+}
+
+static inline int nextRangedCombination128(long n, uint128 last, long min, long max, uint128 *out) {
+    uint128 cut, trimmed, trailed, mask, lastTemp, lastLimit, lastPosition, flipped, first, shifted, rotated, result;
+    long count, valid;
+
+    cut = last >> 1;
+    trimmed = cut | (cut - 1); //Discards trailing zeros
+    trailed = trimmed ^ (trimmed + 1); //Marks the start of the last "01"
+    mask = (trailed << 1) + 1;
+
+    lastTemp = trailed + 1; //Indexes the start of the last "01"
+    lastLimit = (uint128) 1 << (n-1); //Indexes the length of the string
+    lastPosition = (lastTemp == 0 || lastTemp > lastLimit)? lastLimit : lastTemp;
+
+    count = __builtin_popcountl((unsigned long) last) + __builtin_popcountl((unsigned long) (last >> 64));
+    flipped = 1 & ~last;
+    valid = (flipped == 0)? count > min : count < max;
+    first = (trailed < lastLimit || !valid)? 1 & last : flipped; //The bit to be moved
+    shifted = cut & trailed;
+    rotated = (first == 1)? shifted | lastPosition : shifted;
+    result = rotated | (~mask & last);
+
+    if(result == lowBits128(min)) {
+        return -1;
+    }
+
+    *out = result;
+    return 1;
+}
+
+/* Ranks, unranks and counts for strings up to 128 bits long, for 64-bit
+ * strings as well. They follow the functions in combinations.h with 128-bit
+ * counts, which hold every count except the 2^128 strings of length 128.
+ * That count wraps around to 0, and ranks are then taken modulo 2^128, which
+ * is exactly the range of the rank type.
+ */
+static inline uint128 binomial128(long n, long k) {
+    static uint128 table[WIDE_WIDTH + 1][WIDE_WIDTH + 1];
+    static int filled = 0;
+    long i, j;
+
+    if(!filled) {
+        for(i = 0; i <= WIDE_WIDTH; i++) {
+            table[i][0] = 1;
+            for(j = 1; j <= i; j++) {
+                table[i][j] = table[i-1][j-1] + ((j < i)? table[i-1][j] : 0);
+            }
+        }
+        filled = 1;
+    }
+
+    if(k < 0 || k > n) {
+        return 0;
+    }
+    return table[n][k];
+}
+
+/* Adds an offset to a position modulo a sequence length, where a length of 0
+ * stands for 2^128. Both are already below the length, and the sum is
+ * wrapped without overflowing, since lengths come close to 2^128.
+ */
+static inline uint128 offsetRank128(uint128 position, uint128 offset, uint128 count) {
+    return (count == 0 || position < count - offset)? position + offset : position - (count - offset);
+}
+
+static inline uint128 rankWeightedCombination128(long n, uint128 string) {
+    uint128 rank = 0, ones;
+    long i, weight = 0;
+
+    for(i = 0; i < n; i++) {
+        if((string >> i) & 1) {
+            weight++;
+            if(i > 0) { //The prefix moves into the block of strings ending in 1
+                ones = binomial128(i, weight - 1);
+                rank = binomial128(i, weight) + (rank + ones - 1) % ones;
+            }
+        }
+    }
+    return rank;
+}
+
+static inline uint128 unrankWeightedCombination128(long n, long k, uint128 rank) {
+    uint128 string = 0, zeros;
+    long i;
+
+    for(i = n - 1; i >= 0 && k > 0; i--) {
+        zeros = binomial128(i, k); //Strings of this prefix length ending in 0
+        if(rank >= zeros) {
+            string |= (uint128) 1 << i;
+            rank -= zeros;
+            k--;
+            rank = (k > 0 && i > 0)? (rank + 1) % binomial128(i, k) : 0;
+        }
+    }
+    return string;
+}
+
+static inline uint128 rankCoolerBlock128(long n, uint128 string) {
+    uint128 rank = 0;
+    long i, weight = 0;
+
+    for(i = 0; i < n; i++) {
+        if((string >> i) & 1) {
+            weight++;
+            rank = (rank == 0)? 0 : binomial128(i, weight) + rank;
+        } else if(weight > 0) {
+            rank++; //Skip the string with the top bits set
+        }
+    }
+    return rank;
+}
+
+static inline uint128 unrankCoolerBlock128(long n, long w, uint128 rank) {
+    uint128 string = 0;
+    long i;
+
+    for(i = n - 1; i >= 0 && w > 0; i--) {
+        if(w == i + 1) { //Only ones remain
+            string |= lowBits128(w);
+            break;
+        }
+        if(rank == 0) {
+            string |= (uint128) 1 << i;
+            w--;
+        } else if(rank <= binomial128(i, w)) {
+            rank--;
+        } else {
+            string |= (uint128) 1 << i;
+            rank -= binomial128(i, w);
+            w--;
+        }
+    }
+    return string;
+}
+
+static inline uint128 coolestCyclePosition128(long n, uint128 string, long min, long max) {
+    uint128 block, position;
+    long weight, w;
+
+    block = rankCoolerBlock128(n, string);
+    weight = __builtin_popcountl((unsigned long) string) + __builtin_popcountl((unsigned long) (string >> 64));
+
+    if(block == 0) {
+        return weight - min;
+    }
+    position = max - min + 1;
+    for(w = max; w > weight; w--) {
+        position += binomial128(n, w) - 1;
+    }
+    return position + block - 1;
+}
+
+static inline uint128 coolestCycleString128(long n, uint128 position, long min, long max) {
+    long w;
+
+    if(position <= (uint128) (max - min)) {
+        w = min + position;
+        return lowBits128(w) << (n - w);
+    }
+    position -= max - min + 1;
+    for(w = max; position >= binomial128(n, w) - 1; w--) {
+        position -= binomial128(n, w) - 1;
+    }
+    return unrankCoolerBlock128(n, w, position + 1);
+}
+
+static inline uint128 countRangedCombinations128(long n, long min, long max) {
+    uint128 count = 0;
+    long w;
+
+    for(w = min; w <= max; w++) {
+        count += binomial128(n, w);
+    }
+    return count;
+}
+
+static inline uint128 rankGeneralCombination128(long n, uint128 string) {
+    uint128 count = lowBits128(n) + 1;
+    return offsetRank128(coolestCyclePosition128(n, string, 0, n), count - n, count); //All ones are at cycle position n
+}
+
+static inline uint128 unrankGeneralCombination128(long n, uint128 rank) {
+    return coolestCycleString128(n, offsetRank128(rank, n, lowBits128(n) + 1), 0, n);
+}
+
+static inline uint128 rankRangedCombination128(long n, uint128 string, long min, long max) {
+    uint128 count, start;
+
+    count = countRangedCombinations128(n, min, max);
+    start = coolestCyclePosition128(n, lowBits128(min), min, max);
+    return offsetRank128(coolestCyclePosition128(n, string, min, max), count - start, count);
+}
+
+static inline uint128 unrankRangedCombination128(long n, uint128 rank, long min, long max) {
+    uint128 count, start;
+
+    count = countRangedCombinations128(n, min, max);
+    start = coolestCyclePosition128(n, lowBits128(min), min, max);
+    return coolestCycleString128(n, offsetRank128(rank, start, count), min, max);
+}
+
+#endif //__WIDE_COMBINATIONS_H
@@ -0,0 +1,161 @@
+// Tests for the 64-bit and 128-bit software combination sequences
+// (c) Maddie Burbage, 2020
+
+#include "wideCombinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLES 256 //Ranks checked from each long sequence
+
+/* Steps the 128-bit and 64-bit successors for a sequence, which is assumed
+ * to be short enough for 64 bits when the width allows it.
+ */
+static int wideNext(const struct sequence *s, uint128 last, uint128 *out) {
+    unsigned long out64 = 0;
+    int more;
+
+    switch(s->kind) {
+    case FIXED_WEIGHT: more = nextWeightedCombination128(s->length, last, out); break;
+    case GENERAL: more = nextGeneralCombination128(s->length, last, out); break;
+    default: more = nextRangedCombination128(s->length, last, s->min, s->max, out);
+    }
+    if(s->length <= 64) { //The 64-bit successor should agree
+        switch(s->kind) {
+        case FIXED_WEIGHT: more -= nextWeightedCombination64(s->length, last, &out64) != more; break;
+        case GENERAL: more -= nextGeneralCombination64(s->length, last, &out64) != more; break;
+        default: more -= nextRangedCombination64(s->length, last, s->min, s->max, &out64) != more;
+        }
+        if(more == 1 && out64 != *out) {
+            more = 0;
+        }
+    }
+    return more; //0 when the two widths disagree
+}
+
+static uint128 wideCount(const struct sequence *s) {
+    switch(s->kind) {
+    case FIXED_WEIGHT: return binomial128(s->length, s->min);
+    case GENERAL: return lowBits128(s->length) + 1;
+    default: return countRangedCombinations128(s->length, s->min, s->max);
+    }
+}
+
+static uint128 wideString(const struct sequence *s, uint128 rank) {
+    switch(s->kind) {
+    case FIXED_WEIGHT: return unrankWeightedCombination128(s->length, s->min, rank);
+    case GENERAL: return unrankGeneralCombination128(s->length, rank);
+    default: return unrankRangedCombination128(s->length, rank, s->min, s->max);
+    }
+}
+
+static uint128 wideRank(const struct sequence *s, uint128 string) {
+    switch(s->kind) {
+    case FIXED_WEIGHT: return rankWeightedCombination128(s->length, string);
+    case GENERAL: return rankGeneralCombination128(s->length, string);
+    default: return rankRangedCombination128(s->length, string, s->min, s->max);
+    }
+}
+
+/* Walks a short sequence with the original successor, checking that the wide
+ * successors and ranks match it at every step.
+ */
+static int testShort(const struct sequence *s) {
+    unsigned long string, rank = 0;
+    unsigned int next;
+    uint128 wide;
+    int mismatches = 0, more;
+
+    string = sequenceString(s, 0);
+    do {
+        if(wideRank(s, string) != rank || wideString(s, rank) != string) {
+            mismatches++;
+        }
+        more = sequenceNext(s, string, &next);
+        if(wideNext(s, string, &wide) != more || (more == 1 && wide != next)) {
+            mismatches++;
+        }
+        string = next;
+        rank++;
+    } while(more != -1);
+    return mismatches;
+}
+
+/* Checks a long sequence at evenly spaced ranks and at its last rank. The
+ * successor of each unranked string should be the next rank's string.
+ */
+static int testLong(const struct sequence *s) {
+    uint128 count, stride, rank, string, next;
+    int i, mismatches = 0;
+
+    count = wideCount(s);
+    stride = (count == 0)? (uint128) 1 << 120 : count / SAMPLES; //A count of 0 stands for 2^128
+    for(i = 0; i <= SAMPLES; i++) {
+        rank = (i < SAMPLES)? stride * i : count - 1;
+        string = wideString(s, rank);
+        if(wideRank(s, string) != rank) {
+            printf("ERROR: kind %d length %ld rank of sample %d\n", s->kind, s->length, i);
+            mismatches++;
+        }
+        if(rank == count - 1) {
+            if(wideNext(s, string, &next) != -1) {
+                printf("ERROR: kind %d length %ld does not end\n", s->kind, s->length);
+                mismatches++;
+            }
+        } else if(wideNext(s, string, &next) != 1 || next != wideString(s, rank + 1)) {
+            printf("ERROR: kind %d length %ld successor of sample %d\n", s->kind, s->length, i);
+            mismatches++;
+        }
+    }
+    if(wideString(s, 0) != ((s->kind == GENERAL)? lowBits128(s->length) : lowBits128(s->min))) {
+        mismatches++;
+    }
+    return mismatches;
+}
+
+int main(void) {
+    long widths[] = {33, 40, 47, 60, 63, 64, 65, 100, 127, 128};
+    struct sequence s;
+    unsigned int i;
+    long n;
+    int mismatches = 0;
+
+    for(n = 1; n <= 16; n++) {
+        s.length = n;
+        s.kind = FIXED_WEIGHT;
+        s.min = s.max = (n + 1)/2;
+        mismatches += testShort(&s);
+        s.kind = GENERAL;
+        s.min = 0;
+        s.max = n;
+        mismatches += testShort(&s);
+        s.kind = RANGED;
+        s.min = n/4;
+        s.max = n/2 + 1;
+        mismatches += testShort(&s);
+    }
+    printf("Short wide mismatches: %d\n", mismatches);
+
+    for(i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+        s.length = n = widths[i];
+        s.kind = FIXED_WEIGHT;
+        s.min = s.max = n/2;
+        mismatches += testLong(&s);
+        s.min = s.max = n - 1;
+        mismatches += testLong(&s);
+        s.kind = GENERAL;
+        s.min = 0;
+        s.max = n;
+        mismatches += testLong(&s);
+        s.kind = RANGED;
+        s.min = n/3;
+        s.max = 2*n/3;
+        mismatches += testLong(&s);
+        s.min = 0;
+        mismatches += testLong(&s);
+        s.max = n;
+        mismatches += testLong(&s);
+    }
+    printf("Total wide mismatches: %d\n", mismatches);
+    return mismatches;
+}
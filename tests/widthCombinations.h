@@ -0,0 +1,56 @@
+// Software successors specialized on the string width at compile time
+// (c) Maddie Burbage, 2020
+
+#ifndef __WIDTH_COMBINATIONS_H
+#define __WIDTH_COMBINATIONS_H
+
+#include "combinations.h"
+
+/* Each specialization fixes the width (and weight range, for ranged ones) as
+ * a constant and inlines the whole successor into itself, so masks such as
+ * 1L << n and the last position fold into immediates. The name of the
+ * specialization for a width is found with WIDTH_SUCCESSOR(kind, n), for
+ * example WIDTH_SUCCESSOR(nextWeightedCombination, 16).
+ */
+#define WIDTH_SUCCESSOR_NAME(kind, n) kind ## _ ## n
+#define WIDTH_SUCCESSOR(kind, n) WIDTH_SUCCESSOR_NAME(kind, n)
+
+typedef int (*widthSuccessor)(unsigned long last, unsigned int *out);
+typedef int (*widthRangedSuccessor)(unsigned long last, long min, long max, unsigned int *out);
+
+#define SPECIALIZE_WIDTH(n)                                                                             \
+    static inline __attribute__((flatten)) int nextWeightedCombination_ ## n(unsigned long last, unsigned int *out) { \
+        return nextWeightedCombination(n, last, out);                                                   \
+    }                                                                                                   \
+    static inline __attribute__((flatten)) int nextGeneralCombination_ ## n(unsigned long last, unsigned int *out) { \
+        return nextGeneralCombination(n, last, out);                                                    \
+    }                                                                                                   \
+    static inline __attribute__((flatten)) int nextRangedCombination_ ## n(unsigned long last, long min, long max, unsigned int *out) { \
+        return nextRangedCombination(n, last, min, max, out);                                           \
+    }
+
+/* Specializes the ranged successor on its weight range as well as its width,
+ * under the given name, for use where the range is known when compiling.
+ */
+#define SPECIALIZE_RANGE(name, n, min, max)                                                             \
+    static inline __attribute__((flatten)) int name(unsigned long last, unsigned int *out) {           \
+        return nextRangedCombination(n, last, min, max, out);                                           \
+    }
+
+#define FOR_EACH_WIDTH(X)                                                 \
+    X(1) X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9) X(10) X(11) X(12)        \
+    X(13) X(14) X(15) X(16) X(17) X(18) X(19) X(20) X(21) X(22) X(23)     \
+    X(24) X(25) X(26) X(27) X(28) X(29) X(30) X(31) X(32)
+
+FOR_EACH_WIDTH(SPECIALIZE_WIDTH)
+
+#define WEIGHTED_ENTRY(n) WIDTH_SUCCESSOR(nextWeightedCombination, n),
+#define GENERAL_ENTRY(n) WIDTH_SUCCESSOR(nextGeneralCombination, n),
+#define RANGED_ENTRY(n) WIDTH_SUCCESSOR(nextRangedCombination, n),
+
+//Dispatch tables from a width known only at runtime to its specialization
+static const widthSuccessor __attribute__((unused)) weightedSuccessors[MAX_WIDTH + 1] = { 0, FOR_EACH_WIDTH(WEIGHTED_ENTRY) };
+static const widthSuccessor __attribute__((unused)) generalSuccessors[MAX_WIDTH + 1] = { 0, FOR_EACH_WIDTH(GENERAL_ENTRY) };
+static const widthRangedSuccessor __attribute__((unused)) rangedSuccessors[MAX_WIDTH + 1] = { 0, FOR_EACH_WIDTH(RANGED_ENTRY) };
+
+#endif //__WIDTH_COMBINATIONS_H
@@ -0,0 +1,60 @@
+// Tests for the width-specialized software successors
+// (c) Maddie Burbage, 2020
+
+#include "widthCombinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLES 256 //Strings checked from each sequence
+
+/* Compares each width's specializations to the generic successors, starting
+ * from evenly spaced strings of each sequence.
+ */
+static int testWidth(long n) {
+    unsigned long count, stride, i, string;
+    unsigned int expected, found;
+    int mismatches = 0;
+
+    count = binomial(n, n/2);
+    stride = (count < SAMPLES)? 1 : count / SAMPLES;
+    for(i = 0; i < count; i += stride) {
+        string = unrankWeightedCombination(n, n/2, i);
+        expected = found = 0;
+        if(nextWeightedCombination(n, string, &expected) != weightedSuccessors[n](string, &found) || expected != found) {
+            mismatches++;
+        }
+    }
+
+    count = 1L << n;
+    stride = (count < SAMPLES)? 1 : count / SAMPLES;
+    for(i = 0; i < count; i += stride) {
+        string = unrankGeneralCombination(n, i);
+        expected = found = 0;
+        if(nextGeneralCombination(n, string, &expected) != generalSuccessors[n](string, &found) || expected != found) {
+            mismatches++;
+        }
+    }
+
+    count = countRangedCombinations(n, 1, n/2 + 1);
+    stride = (count < SAMPLES)? 1 : count / SAMPLES;
+    for(i = 0; i < count; i += stride) {
+        string = unrankRangedCombination(n, i, 1, n/2 + 1);
+        expected = found = 0;
+        if(nextRangedCombination(n, string, 1, n/2 + 1, &expected) != rangedSuccessors[n](string, 1, n/2 + 1, &found) || expected != found) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+int main(void) {
+    long n;
+    int mismatches = 0;
+
+    for(n = 1; n <= MAX_WIDTH; n++) {
+        mismatches += testWidth(n);
+    }
+    printf("Width specialization mismatches: %d\n", mismatches);
+    return mismatches;
+}